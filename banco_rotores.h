@@ -0,0 +1,281 @@
+/**
+ * @file banco_rotores.h
+ * @brief Banco de rotores en cascada con tabla compuesta (--rotors)
+ *
+ * @details
+ * El firmware nuevo encadena varios rotores al estilo Enigma: cada
+ * fragmento atraviesa los rotores en orden y las tramas "M,<rotor>,<N>"
+ * giran uno concreto. Recorrer todos los rotores en cada LOAD multiplicaría
+ * su coste, así que el banco guarda la composición en una tabla de 256
+ * entradas y la recalcula solo cuando algún rotor se mueve (una MAP o un
+ * paso de la regla de avance): cada LOAD sigue siendo una sola consulta.
+ */
+
+#ifndef PRT7_BANCO_ROTORES_H
+#define PRT7_BANCO_ROTORES_H
+
+#include <iostream>
+
+#include "estructuras.h"
+
+/**
+ * @enum ReglaPaso
+ * @brief Cómo avanzan los rotores por sí solos
+ */
+enum ReglaPaso {
+    PASO_NINGUNO,        ///< Solo las tramas MAP mueven los rotores
+    PASO_ODOMETRO        ///< Cada LOAD avanza el rotor 0; la vuelta completa arrastra al siguiente
+};
+
+/**************************************************************************
+ * @class BancoAlfabeto
+ * @brief Varios rotores de un mismo alfabeto aplicados en cascada
+ * @tparam Alfabeto AlfabetoLatino, AlfabetoAlfanumerico, AlfabetoImprimible...
+ *
+ * @details
+ * El rotor r con desplazamiento o_r y cableado W_r lleva la posición p a
+ * W_r[(p + o_r) mod TAMANO]; el banco aplica los rotores 0..n-1 en orden.
+ * El rotor 0 tiene cableado identidad, así que un banco de un rotor sin
+ * regla de avance decodifica igual que RotorAlfabeto. Los demás usan una
+ * permutación afín fija distinta para cada uno.
+ *
+ * La tabla compuesta solo cambia en las posiciones de los bytes del
+ * alfabeto (p. ej. A-Z y a-z); el resto se fija en el constructor. Como el
+ * rotor 0 (el que más se mueve con PASO_ODOMETRO) es un simple
+ * desplazamiento, la composición de los rotores 1..n-1 se guarda aparte y
+ * solo se rehace cuando uno de ellos gira: un paso del rotor 0 cuesta una
+ * consulta por byte del alfabeto.
+ **************************************************************************/
+template <class Alfabeto>
+class BancoAlfabeto {
+public:
+    static const int MAX_ROTORES = 8;                  ///< Rotores por banco
+
+private:
+    static constexpr int TAMANO = Alfabeto::TAMANO;   ///< Tamaño del alfabeto
+    typedef TablasAlfabeto<Alfabeto> Tablas;           ///< Tablas constexpr
+
+    int n;                                     ///< Rotores en uso (1..MAX_ROTORES)
+    ReglaPaso regla;                           ///< Avance automático tras cada LOAD
+    Verbosidad nivel;                          ///< Nivel de detalle de rotar()/imprimirEstado()
+    int offset[MAX_ROTORES];                   ///< Posición de cada rotor (0..TAMANO-1)
+    unsigned char cableado[MAX_ROTORES][TAMANO];   ///< Permutación de posiciones de cada rotor
+    unsigned char miembros[256];               ///< Bytes que pertenecen al alfabeto
+    int nMiembros;                             ///< Entradas válidas en miembros
+    unsigned char resto[2 * TAMANO];           ///< Composición de los rotores 1..n-1, duplicada
+    char tabla[256];                           ///< Composición de todos los rotores
+    long recalculos;                           ///< Veces que se recalculó la tabla
+
+    /**
+     * @brief Máximo común divisor
+     * @param a Primer entero positivo
+     * @param b Segundo entero positivo
+     * @return mcd(a, b)
+     */
+    static int mcd(int a, int b) {
+        while (b != 0) {
+            int r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+
+    /**
+     * @brief Recalcula la composición de los rotores 1..n-1
+     * @post resto[p] == resto[p + TAMANO] es la salida de esos rotores para p
+     */
+    void recalcularResto() {
+        for (int p = 0; p < TAMANO; ++p) {
+            int q = p;
+            for (int r = 1; r < n; ++r) {
+                q += offset[r];
+                if (q >= TAMANO) q -= TAMANO;
+                q = cableado[r][q];
+            }
+            resto[p] = resto[p + TAMANO] = (unsigned char)q;
+        }
+    }
+
+    /**
+     * @brief Recalcula la tabla compuesta con las posiciones actuales
+     * @pre resto está al día con los rotores 1..n-1
+     * @post tabla[b] es la salida del banco para el byte b
+     */
+    void recalcular() {
+        const unsigned char* r = resto + offset[0];
+        for (int k = 0; k < nMiembros; ++k) {
+            unsigned char b = miembros[k];
+            tabla[b] = Tablas::simbolos[r[Tablas::indice[b]]];
+        }
+        ++recalculos;
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param rotores Número de rotores (se ajusta a 1..MAX_ROTORES)
+     * @param r Regla de avance automático
+     * @post Todos los rotores en la posición 0
+     */
+    BancoAlfabeto(int rotores, ReglaPaso r)
+        : n(rotores < 1 ? 1 : (rotores > MAX_ROTORES ? MAX_ROTORES : rotores)),
+          regla(r), nivel(VERB_TRAZA), nMiembros(0), recalculos(0) {
+        for (int k = 0; k < n; ++k) {
+            // Multiplicador: el k-ésimo entero mayor que 1 primo con TAMANO
+            int m = 1;
+            for (int encontrados = 0; encontrados < k; ) {
+                ++m;
+                if (mcd(m, TAMANO) == 1) ++encontrados;
+            }
+            offset[k] = 0;
+            for (int p = 0; p < TAMANO; ++p)
+                cableado[k][p] = (unsigned char)((m * p + k) % TAMANO);
+        }
+        for (int b = 0; b < 256; ++b) {
+            tabla[b] = (char)b;
+            if (Tablas::indice[b] >= 0) miembros[nMiembros++] = (unsigned char)b;
+        }
+        recalcularResto();
+        recalcular();
+    }
+
+    /**
+     * @brief Rota un rotor del banco N posiciones
+     * @param r Rotor (0..getRotores()-1)
+     * @param N Número de posiciones a rotar (+ derecha, - izquierda)
+     * @return false si el rotor no existe (el banco no cambia)
+     * @post La tabla compuesta refleja la nueva posición
+     */
+    bool rotar(int r, int N) {
+        if (r < 0 || r >= n) return false;
+        int effective = N % TAMANO;
+        if (effective < 0) effective += TAMANO;
+
+        offset[r] += effective;
+        if (offset[r] >= TAMANO) offset[r] -= TAMANO;
+        if (effective != 0) {
+            if (r > 0) recalcularResto();
+            recalcular();
+        }
+
+        if (nivel >= VERB_TRAZA) {
+            std::cout << " -> ROTANDO ROTOR " << r << " " << (N >= 0 ? "+" : "") << N
+                 << " (efectivo: +" << effective << ")" << '\n';
+        }
+        return true;
+    }
+
+    /**
+     * @brief Aplica la regla de avance tras un LOAD
+     * @post Con PASO_ODOMETRO el rotor 0 avanza una posición; cada rotor
+     * que completa la vuelta avanza además el siguiente
+     */
+    void avanzar() {
+        if (regla == PASO_NINGUNO) return;
+        if (++offset[0] == TAMANO) {
+            offset[0] = 0;
+            for (int r = 1; r < n; ++r) {
+                if (++offset[r] < TAMANO) break;
+                offset[r] = 0;
+            }
+            recalcularResto();
+        }
+        recalcular();
+    }
+
+    /**
+     * @brief Obtiene el carácter mapeado por la cascada completa
+     * @param in Carácter de entrada a decodificar
+     * @return Carácter decodificado (una consulta a la tabla compuesta)
+     * @details No aplica la regla de avance: eso lo hace avanzar()
+     */
+    char getMapeo(char in) const { return tabla[(unsigned char)in]; }
+
+    /**
+     * @brief Traduce un buffer completo aplicando la regla de avance
+     * @param in Fragmentos de entrada
+     * @param out Destino (puede coincidir con in)
+     * @param cuantos Número de bytes
+     * @post Mismo resultado que getMapeo() + avanzar() por cada byte
+     */
+    void traducir(const char* in, char* out, size_t cuantos) {
+        if (regla == PASO_NINGUNO) {
+            for (size_t k = 0; k < cuantos; ++k) out[k] = tabla[(unsigned char)in[k]];
+            return;
+        }
+        for (size_t k = 0; k < cuantos; ++k) {
+            out[k] = tabla[(unsigned char)in[k]];
+            avanzar();
+        }
+    }
+
+    /**
+     * @brief Imprime la posición de cada rotor y el mapeo compuesto
+     * @details El mapeo se muestra como la salida de cada símbolo del alfabeto
+     */
+    void imprimirEstado() const {
+        if (nivel < VERB_TRAZA) return;
+        std::cout << "Estado banco:";
+        for (int r = 0; r < n; ++r) std::cout << " r" << r << "=+" << offset[r];
+        std::cout << " | ";
+        for (int p = 0; p < TAMANO; ++p)
+            std::cout << tabla[(unsigned char)Alfabeto::simbolo(p)];
+        std::cout << '\n';
+    }
+
+    /**
+     * @brief Número de rotores del banco
+     * @return Rotores en uso
+     */
+    int getRotores() const { return n; }
+
+    /**
+     * @brief Devuelve el número de posiciones de cada rotor
+     * @return Tamaño del alfabeto
+     */
+    int getTamano() const { return TAMANO; }
+
+    /**
+     * @brief Posición de un rotor
+     * @param r Rotor (0..getRotores()-1)
+     * @return Desplazamiento respecto del primer símbolo (0..TAMANO-1)
+     */
+    int getOffset(int r) const { return offset[r]; }
+
+    /**
+     * @brief Veces que se recalculó la tabla compuesta
+     * @return Contador de recálculos (incluido el del constructor)
+     */
+    long getRecalculos() const { return recalculos; }
+
+    /**
+     * @brief Fija el nivel de detalle de rotar() e imprimirEstado()
+     * @param v Nivel de verbosidad
+     */
+    void fijarVerbosidad(Verbosidad v) { nivel = v; }
+
+    /**
+     * @brief Devuelve el nivel de detalle configurado
+     * @return Nivel de verbosidad
+     */
+    Verbosidad getVerbosidad() const { return nivel; }
+};
+
+template <class Alfabeto>
+const int BancoAlfabeto<Alfabeto>::MAX_ROTORES;
+
+template <class Alfabeto>
+constexpr int BancoAlfabeto<Alfabeto>::TAMANO;
+
+/**
+ * @typedef BancoRotores
+ * @brief Banco con el alfabeto del rotor activo
+ */
+#ifdef PRT7_ALFANUMERICO
+typedef BancoAlfabeto<AlfabetoAlfanumerico> BancoRotores;
+#else
+typedef BancoAlfabeto<AlfabetoLatino> BancoRotores;
+#endif
+
+#endif // PRT7_BANCO_ROTORES_H
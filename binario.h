@@ -0,0 +1,262 @@
+/**
+ * @file binario.h
+ * @brief Formato binario compacto de tramas PRT-7
+ *
+ * @details
+ * Alternativa al protocolo de texto "L,X" / "M,N". Las tramas viajan en
+ * bloques con marca de sincronía y CRC:
+ *
+ * @code
+ * 0xA7 0x5A <len> <registros: len bytes> <crc8(len + registros)>
+ * @endcode
+ *
+ * Registros dentro de un bloque:
+ * - 0x4C c : LOAD con el fragmento c
+ * - 0x52 k c1..ck : k tramas LOAD consecutivas (racha)
+ * - 0x4D varint : MAP con el desplazamiento codificado en zigzag + varint
+ * - 0x4E varint varint : MAP "M,<rotor>,N" para un banco de rotores (--rotors),
+ *   con el rotor y el desplazamiento en zigzag + varint
+ *
+ * Una trama LOAD dentro de una racha ocupa un byte, frente a los 4 de
+ * "L,X\n". Si el CRC no coincide el bloque se descarta y el lector busca
+ * la siguiente marca de sincronía.
+ */
+
+#ifndef PRT7_BINARIO_H
+#define PRT7_BINARIO_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "tramas.h"
+
+static const unsigned char BIN_SYNC0 = 0xA7;       ///< Primer byte de la marca de sincronía
+static const unsigned char BIN_SYNC1 = 0x5A;       ///< Segundo byte de la marca de sincronía
+static const unsigned char BIN_ETIQ_LOAD = 0x4C;   ///< Registro LOAD ('L')
+static const unsigned char BIN_ETIQ_MAP = 0x4D;    ///< Registro MAP ('M')
+static const unsigned char BIN_ETIQ_RACHA = 0x52;  ///< Racha de LOAD ('R')
+static const unsigned char BIN_ETIQ_MAP_ROTOR = 0x4E;  ///< MAP dirigida a un rotor del banco ('N')
+static const size_t BIN_MAX_CARGA = 255;           ///< Bytes de registros por bloque
+static const size_t BIN_CABECERA = 3;              ///< Marca de sincronía + longitud
+
+/**
+ * @brief CRC-8 (polinomio 0x07, valor inicial 0)
+ * @param p Datos
+ * @param n Número de bytes
+ * @return CRC de los datos
+ */
+inline unsigned char crc8(const unsigned char* p, size_t n) {
+    unsigned char crc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        crc ^= p[i];
+        for (int b = 0; b < 8; ++b)
+            crc = (unsigned char)((crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1));
+    }
+    return crc;
+}
+
+/**
+ * @brief Codifica un entero en zigzag + varint
+ * @param valor Entero a codificar
+ * @param out Destino (al menos 5 bytes)
+ * @return Bytes escritos
+ */
+inline size_t escribirVarint(int valor, unsigned char* out) {
+    unsigned int z = ((unsigned int)valor << 1) ^ (unsigned int)(valor >> 31);
+    size_t n = 0;
+    while (z >= 0x80) {
+        out[n++] = (unsigned char)(z | 0x80);
+        z >>= 7;
+    }
+    out[n++] = (unsigned char)z;
+    return n;
+}
+
+/**
+ * @brief Decodifica un entero zigzag + varint
+ * @param p Posición de lectura; avanza tras el valor
+ * @param fin Fin de los datos disponibles
+ * @param valor Recibe el entero decodificado
+ * @return false si el varint está truncado o excede 32 bits
+ */
+inline bool leerVarint(const unsigned char*& p, const unsigned char* fin, int& valor) {
+    unsigned int z = 0;
+    for (int desplaz = 0; desplaz < 35; desplaz += 7) {
+        if (p >= fin) return false;
+        unsigned char b = *p++;
+        z |= (unsigned int)(b & 0x7F) << desplaz;
+        if (!(b & 0x80)) {
+            valor = (int)((z >> 1) ^ (0u - (z & 1)));
+            return true;
+        }
+    }
+    return false;
+}
+
+/**************************************************************************
+ * @struct LectorBloque
+ * @brief Recorre los registros de un bloque ya validado
+ **************************************************************************/
+struct LectorBloque {
+    const unsigned char* p;    ///< Siguiente byte de registros
+    const unsigned char* fin;  ///< Fin de los registros del bloque
+    size_t racha;              ///< LOAD pendientes de la racha actual
+
+    /**
+     * @brief Constructor
+     * @param carga Registros del bloque (sin cabecera ni CRC)
+     * @param len Longitud de los registros
+     */
+    LectorBloque(const unsigned char* carga, size_t len)
+        : p(carga), fin(carga + len), racha(0) {}
+
+    /**
+     * @brief Extrae la siguiente trama del bloque
+     * @param t Recibe la trama; TRAMA_INVALIDA si el registro está mal formado
+     * @return false al terminar el bloque o tras un registro inválido
+     */
+    bool siguiente(Trama& t) {
+        if (racha > 0) {
+            --racha;
+            t.tipo = TRAMA_LOAD;
+            t.fragmento = (char)*p++;
+            return true;
+        }
+        if (p >= fin) return false;
+        unsigned char etiq = *p++;
+        t.tipo = TRAMA_INVALIDA;
+        if (etiq == BIN_ETIQ_LOAD && p < fin) {
+            t.tipo = TRAMA_LOAD;
+            t.fragmento = (char)*p++;
+            return true;
+        }
+        if (etiq == BIN_ETIQ_RACHA && p < fin && *p > 0 && (size_t)(fin - p) > *p) {
+            racha = *p++;
+            return siguiente(t);
+        }
+        if (etiq == BIN_ETIQ_MAP && leerVarint(p, fin, t.desplazamiento)) {
+            t.tipo = TRAMA_MAP;
+            t.rotor = 0;
+            return true;
+        }
+        if (etiq == BIN_ETIQ_MAP_ROTOR && leerVarint(p, fin, t.rotor) && t.rotor >= 0
+            && leerVarint(p, fin, t.desplazamiento)) {
+            t.tipo = TRAMA_MAP;
+            return true;
+        }
+        p = fin;
+        return true;
+    }
+};
+
+/**************************************************************************
+ * @class EscritorBinario
+ * @brief Empaqueta tramas en bloques binarios y los escribe en un FILE*
+ *
+ * @details
+ * Un LOAD suelto ocupa un registro 0x4C; a partir del segundo LOAD seguido
+ * el registro pasa a ser una racha 0x52. Cada bloque se
+ * emite cuando el siguiente registro ya no cabe o al llamar a vaciar().
+ **************************************************************************/
+class EscritorBinario {
+private:
+    FILE* salida;                                   ///< Destino de los bloques
+    unsigned char bloque[BIN_CABECERA + BIN_MAX_CARGA + 1];  ///< Bloque en construcción
+    size_t usados;          ///< Bytes de registros del bloque actual
+    size_t inicioRacha;     ///< Posición del contador de la racha abierta (0 = ninguna)
+    size_t cargaSuelta;     ///< Posición del último registro LOAD suelto (0 = ninguno)
+    long bloques;           ///< Bloques emitidos
+    long bytes;             ///< Bytes emitidos
+
+    /**
+     * @brief Reserva espacio para un registro, emitiendo el bloque si no cabe
+     * @param n Bytes del registro
+     * @return Puntero donde escribir el registro
+     */
+    unsigned char* reservar(size_t n) {
+        if (usados + n > BIN_MAX_CARGA) vaciar();
+        unsigned char* r = bloque + BIN_CABECERA + usados;
+        usados += n;
+        return r;
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param f Archivo abierto en modo binario
+     */
+    EscritorBinario(FILE* f) : salida(f), usados(0), inicioRacha(0), cargaSuelta(0), bloques(0), bytes(0) {
+        bloque[0] = BIN_SYNC0;
+        bloque[1] = BIN_SYNC1;
+    }
+
+    /**
+     * @brief Añade una trama al bloque actual
+     * @param t Trama LOAD o MAP (las inválidas se ignoran)
+     */
+    void escribir(const Trama& t) {
+        if (t.tipo == TRAMA_LOAD) {
+            if (inicioRacha && bloque[inicioRacha] < 0xFF && usados < BIN_MAX_CARGA) {
+                ++bloque[inicioRacha];
+                bloque[BIN_CABECERA + usados++] = (unsigned char)t.fragmento;
+                return;
+            }
+            if (cargaSuelta && usados + 2 <= BIN_MAX_CARGA) {
+                // Segundo LOAD seguido: "L c" se convierte en "R 2 c c'"
+                unsigned char* r = bloque + cargaSuelta;
+                r[2] = r[1];
+                r[0] = BIN_ETIQ_RACHA;
+                r[1] = 2;
+                r[3] = (unsigned char)t.fragmento;
+                usados += 2;
+                inicioRacha = cargaSuelta + 1;
+                cargaSuelta = 0;
+                return;
+            }
+            unsigned char* r = reservar(2);
+            r[0] = BIN_ETIQ_LOAD;
+            r[1] = (unsigned char)t.fragmento;
+            cargaSuelta = (size_t)(r - bloque);
+            inicioRacha = 0;
+        } else if (t.tipo == TRAMA_MAP) {
+            unsigned char tmp[10];
+            size_t n = 0;
+            if (t.rotor != 0) n = escribirVarint(t.rotor, tmp);
+            n += escribirVarint(t.desplazamiento, tmp + n);
+            unsigned char* r = reservar(1 + n);
+            r[0] = (t.rotor != 0 ? BIN_ETIQ_MAP_ROTOR : BIN_ETIQ_MAP);
+            memcpy(r + 1, tmp, n);
+            inicioRacha = cargaSuelta = 0;
+        }
+    }
+
+    /**
+     * @brief Emite el bloque en construcción, si tiene registros
+     */
+    void vaciar() {
+        inicioRacha = cargaSuelta = 0;
+        if (usados == 0) return;
+        bloque[2] = (unsigned char)usados;
+        bloque[BIN_CABECERA + usados] = crc8(bloque + 2, usados + 1);
+        size_t total = BIN_CABECERA + usados + 1;
+        fwrite(bloque, 1, total, salida);
+        ++bloques;
+        bytes += (long)total;
+        usados = 0;
+    }
+
+    /**
+     * @brief Bloques emitidos hasta ahora
+     * @return Contador de bloques
+     */
+    long getBloques() const { return bloques; }
+
+    /**
+     * @brief Bytes emitidos hasta ahora
+     * @return Contador de bytes
+     */
+    long getBytes() const { return bytes; }
+};
+
+#endif // PRT7_BINARIO_H
@@ -0,0 +1,202 @@
+/**
+ * @file canal.h
+ * @brief Canal productor/consumidor sin bloqueos entre el lector y el decodificador
+ *
+ * @details
+ * Cola circular de capacidad fija para exactamente un hilo productor y un
+ * hilo consumidor (SPSC). Cada índice lo escribe un solo hilo y se publica
+ * con semántica release/acquire, así que no hacen falta mutex. Cuando el
+ * canal se llena o se vacía, el hilo afectado espera cediendo la CPU y la
+ * espera se contabiliza como contrapresión.
+ */
+
+#ifndef PRT7_CANAL_H
+#define PRT7_CANAL_H
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <thread>
+
+/**
+ * @struct RanuraLinea
+ * @brief Una línea de texto (o un bloque binario) copiada al canal
+ * @details Las líneas más largas que CAPACIDAD se truncan, igual que en la
+ * ruta polimórfica; ninguna trama válida se acerca a ese tamaño.
+ */
+struct RanuraLinea {
+    static const size_t CAPACIDAD = 256;   ///< Bytes por ranura
+    unsigned short largo;                  ///< Bytes válidos en datos
+    char datos[CAPACIDAD];                 ///< Contenido (sin terminar en '\0')
+};
+
+/**************************************************************************
+ * @class CanalSPSC
+ * @brief Cola circular sin bloqueos de un productor y un consumidor
+ * @tparam T Tipo de cada ranura
+ * @tparam N Número de ranuras (potencia de dos)
+ *
+ * @details
+ * El productor reserva la ranura de cabeza, la llena y la publica; el
+ * consumidor lee la ranura de cola y la libera. Los contadores de espera
+ * y la ocupación máxima los escribe un solo hilo cada uno y se consultan
+ * después de unir los hilos.
+ **************************************************************************/
+template <class T, size_t N>
+class CanalSPSC {
+private:
+    static const size_t MASCARA = N - 1;   ///< Índice módulo N
+    static const int GIROS = 64;           ///< Reintentos con yield antes de dormir
+
+    T* ranuras;                            ///< Almacenamiento de las N ranuras
+    std::atomic<size_t> cabeza;            ///< Próxima ranura a escribir (productor)
+    char relleno1[64];                     ///< Separa cabeza y cola en líneas de caché
+    std::atomic<size_t> cola;              ///< Próxima ranura a leer (consumidor)
+    char relleno2[64];                     ///< Separa cola del resto del estado
+    std::atomic<bool> cerrado;             ///< El productor ya no publicará más
+    long publicadas;                       ///< Ranuras publicadas (productor)
+    long esperasLleno;                     ///< Veces que el productor halló el canal lleno
+    size_t ocupacionMaxima;                ///< Mayor ocupación observada por el productor
+    long esperasVacio;                     ///< Veces que el consumidor halló el canal vacío
+
+    /**
+     * @brief Espera breve: cede la CPU y, tras varios intentos, duerme
+     * @param intento Número de intentos consecutivos hasta ahora
+     */
+    static void esperar(int intento) {
+        if (intento < GIROS) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+public:
+    /**
+     * @brief Constructor - reserva las ranuras en el heap
+     */
+    CanalSPSC() : ranuras(new T[N]), cabeza(0), cola(0), cerrado(false),
+                  publicadas(0), esperasLleno(0), ocupacionMaxima(0), esperasVacio(0) {
+        static_assert((N & (N - 1)) == 0, "N debe ser potencia de dos");
+    }
+
+    /**
+     * @brief Destructor - libera las ranuras
+     */
+    ~CanalSPSC() { delete[] ranuras; }
+
+    /**
+     * @brief Reserva la siguiente ranura libre (productor)
+     * @param detener Si se vuelve distinta de 0, se abandona la espera
+     * @return Ranura a llenar, o nullptr si se pidió detener
+     * @details Si el canal está lleno espera a que el consumidor avance
+     */
+    T* reservarEsperando(volatile sig_atomic_t* detener) {
+        size_t c = cabeza.load(std::memory_order_relaxed);
+        size_t ocupadas = c - cola.load(std::memory_order_acquire);
+        if (ocupadas == N) {
+            ++esperasLleno;
+            for (int i = 0; ocupadas == N; ++i) {
+                if (detener && *detener) return nullptr;
+                esperar(i);
+                ocupadas = c - cola.load(std::memory_order_acquire);
+            }
+        }
+        if (ocupadas + 1 > ocupacionMaxima) ocupacionMaxima = ocupadas + 1;
+        return &ranuras[c & MASCARA];
+    }
+
+    /**
+     * @brief Publica la ranura reservada (productor)
+     */
+    void publicar() {
+        cabeza.store(cabeza.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        ++publicadas;
+    }
+
+    /**
+     * @brief Indica que el productor terminó (productor)
+     */
+    void cerrar() { cerrado.store(true, std::memory_order_release); }
+
+    /**
+     * @brief Indica si no hay ranuras publicadas sin consumir (consumidor)
+     * @return true si frenteEsperando() tendría que esperar al productor
+     */
+    bool vacio() const {
+        return cabeza.load(std::memory_order_acquire) == cola.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Devuelve la ranura más antigua sin consumir (consumidor)
+     * @param plazoMs Máximo de espera con el canal vacío (-1 = sin límite)
+     * @param vencido Si no es nullptr, recibe true cuando se agotó el plazo
+     * @return Ranura publicada, o nullptr si el canal está vacío y cerrado
+     * (o venció el plazo)
+     * @details Si el canal está vacío pero abierto espera al productor
+     */
+    const T* frenteEsperando(int plazoMs = -1, bool* vencido = nullptr) {
+        size_t t = cola.load(std::memory_order_relaxed);
+        if (vencido) *vencido = false;
+        if (cabeza.load(std::memory_order_acquire) == t) {
+            ++esperasVacio;
+            std::chrono::steady_clock::time_point limite =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(plazoMs);
+            for (int i = 0; cabeza.load(std::memory_order_acquire) == t; ++i) {
+                // Revisar cabeza después de cerrado para no perder la última ranura
+                if (cerrado.load(std::memory_order_acquire)
+                    && cabeza.load(std::memory_order_acquire) == t)
+                    return nullptr;
+                if (plazoMs >= 0 && i >= GIROS && std::chrono::steady_clock::now() >= limite) {
+                    if (vencido) *vencido = true;
+                    return nullptr;
+                }
+                esperar(i);
+            }
+        }
+        return &ranuras[t & MASCARA];
+    }
+
+    /**
+     * @brief Libera la ranura devuelta por frenteEsperando() (consumidor)
+     */
+    void liberar() {
+        cola.store(cola.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Número de ranuras del canal
+     * @return N
+     */
+    size_t getCapacidad() const { return N; }
+
+    /**
+     * @brief Ranuras publicadas por el productor
+     * @return Total de líneas o bloques transferidos
+     */
+    long getPublicadas() const { return publicadas; }
+
+    /**
+     * @brief Veces que el productor encontró el canal lleno
+     * @return Contador de contrapresión del lector
+     */
+    long getEsperasLleno() const { return esperasLleno; }
+
+    /**
+     * @brief Veces que el consumidor encontró el canal vacío
+     * @return Contador de esperas del decodificador
+     */
+    long getEsperasVacio() const { return esperasVacio; }
+
+    /**
+     * @brief Mayor número de ranuras ocupadas a la vez
+     * @return Ocupación máxima observada
+     */
+    size_t getOcupacionMaxima() const { return ocupacionMaxima; }
+};
+
+/**
+ * @typedef CanalLineas
+ * @brief Canal del pipeline de main: 16384 líneas (unos 4 MiB)
+ */
+typedef CanalSPSC<RanuraLinea, 16384> CanalLineas;
+
+#endif // PRT7_CANAL_H
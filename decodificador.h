@@ -0,0 +1,269 @@
+/**
+ * @file decodificador.h
+ * @brief Bucle de decodificación de tramas PRT-7
+ *
+ * @details
+ * Decodificador agrupa el estado de una sesión (lista de carga, rotor,
+ * rotación pendiente y contadores) y aplica las tramas en orden. Permite
+ * plegar las tramas MAP consecutivas en una sola rotación neta que se
+ * aplica justo antes del siguiente LOAD. Fuera de la traza agrupa además
+ * las rachas de LOAD y las decodifica por lotes con decodificarLote().
+ * Con un banco de rotores (--rotors) los fragmentos pasan por la tabla
+ * compuesta del banco en lugar del rotor único.
+ */
+
+#ifndef PRT7_DECODIFICADOR_H
+#define PRT7_DECODIFICADOR_H
+
+#include <iostream>
+
+#include "estructuras.h"
+#include "tramas.h"
+#include "lote.h"
+#include "banco_rotores.h"
+
+/**************************************************************************
+ * @class Decodificador
+ * @brief Aplica tramas sobre una ListaDeCarga y un rotor
+ *
+ * @details
+ * Con el plegado activo, cada MAP solo suma su desplazamiento (módulo el
+ * tamaño del rotor) a una rotación pendiente; el rotor se gira una única
+ * vez cuando el siguiente LOAD necesita getMapeo(), o al finalizar. En
+ * modo traza cada MAP se sigue reportando individualmente.
+ *
+ * Sin traza, los fragmentos LOAD se acumulan en un lote mientras el rotor
+ * no cambia; el lote se vacía ante cada MAP, cuando se llena y al
+ * finalizar. La lista de carga solo está completa tras finalizar().
+ *
+ * Con banco de rotores las tramas "M,<rotor>,N" giran el rotor indicado y
+ * "M,N" el rotor 0; no se pliegan, porque el banco ya solo recalcula su
+ * tabla cuando algún rotor cambia. Sin banco, una MAP dirigida a un rotor
+ * distinto del 0 se descarta como inválida.
+ **************************************************************************/
+class Decodificador {
+private:
+    ListaDeCarga* carga;     ///< Lista donde se ensambla el mensaje
+    RotorActivo* rotor;      ///< Rotor de mapeo
+    BancoRotores* banco;     ///< Banco de rotores en cascada (nullptr = rotor único)
+    bool plegar;             ///< Si es true, las MAP consecutivas se pliegan
+    int pendiente;           ///< Rotación neta aún no aplicada (0..tamaño-1)
+    long loads;              ///< Tramas LOAD procesadas
+    long maps;               ///< Tramas MAP procesadas
+    long invalidas;          ///< Líneas descartadas por el parser
+    long rotaciones;         ///< Veces que se giró efectivamente el rotor
+
+    static const size_t CAPACIDAD_LOTE = 4096;  ///< Fragmentos por lote
+    char lote[CAPACIDAD_LOTE];  ///< Fragmentos LOAD aún no decodificados
+    size_t enLote;           ///< Fragmentos acumulados en lote
+
+    /**
+     * @brief Indica si se debe imprimir la traza por trama
+     * @return true en VERB_TRAZA
+     */
+    bool traza() const { return carga->getVerbosidad() >= VERB_TRAZA; }
+
+public:
+    /**
+     * @brief Constructor
+     * @param c Lista de carga de la sesión
+     * @param r Rotor de la sesión
+     * @param plegarMap true para plegar tramas MAP consecutivas
+     */
+    Decodificador(ListaDeCarga* c, RotorActivo* r, bool plegarMap)
+        : carga(c), rotor(r), banco(nullptr), plegar(plegarMap), pendiente(0),
+          loads(0), maps(0), invalidas(0), rotaciones(0), enLote(0) {}
+
+    /**
+     * @brief Decodifica el lote acumulado con la posición actual del rotor
+     * @post enLote == 0 y los fragmentos están al final de la lista de carga
+     */
+    void vaciarLote() {
+        if (enLote == 0) return;
+        if (banco) banco->traducir(lote, lote, enLote);
+        else decodificarLote(lote, lote, enLote, *rotor);
+        carga->insertarBloque(lote, enLote);
+        enLote = 0;
+    }
+
+    /**
+     * @brief Decodifica con un banco de rotores en lugar del rotor único
+     * @param b Banco de la sesión (nullptr vuelve al rotor único)
+     * @pre Se llama antes de procesar la primera trama
+     */
+    void usarBanco(BancoRotores* b) { banco = b; }
+
+    /**
+     * @brief Aplica una trama MAP al banco de rotores
+     * @param t Trama MAP ya parseada
+     */
+    void rotarBanco(const Trama& t) {
+        vaciarLote();
+        if (traza()) {
+            std::cout << "Trama: [M," << t.rotor << "," << t.desplazamiento << "] -> Procesando... ";
+        }
+        if (!banco->rotar(t.rotor, t.desplazamiento)) {
+            ++invalidas;
+            if (traza()) std::cout << " -> rotor inexistente (el banco tiene "
+                                   << banco->getRotores() << ")\n";
+            return;
+        }
+        banco->imprimirEstado();
+        ++maps;
+        ++rotaciones;
+    }
+
+    /**
+     * @brief Aplica al rotor la rotación pendiente, si la hay
+     * @post pendiente == 0
+     */
+    void aplicarPendiente() {
+        if (pendiente == 0) return;
+        if (traza()) std::cout << "Rotación acumulada:";
+        rotor->rotar(pendiente);
+        rotor->imprimirEstado();
+        pendiente = 0;
+        ++rotaciones;
+    }
+
+    /**
+     * @brief Procesa una trama por valor
+     * @param t Trama ya parseada
+     */
+    void procesar(const Trama& t) {
+        switch (t.tipo) {
+        case TRAMA_LOAD:
+            ++loads;
+            if (!traza()) {
+                if (pendiente != 0) {
+                    vaciarLote();
+                    aplicarPendiente();
+                }
+                lote[enLote++] = t.fragmento;
+                if (enLote == CAPACIDAD_LOTE) vaciarLote();
+                break;
+            }
+            if (banco) {
+                TramaLoad::ejecutar(t.fragmento, carga, banco);
+                banco->avanzar();
+                break;
+            }
+            aplicarPendiente();
+            TramaLoad::ejecutar(t.fragmento, carga, rotor);
+            break;
+        case TRAMA_MAP:
+            if (banco) {
+                rotarBanco(t);
+                break;
+            }
+            if (t.rotor != 0) {
+                ++invalidas;
+                if (traza()) std::cout << "Trama MAP para el rotor " << t.rotor
+                                       << " sin banco de rotores (--rotors).\n";
+                break;
+            }
+            ++maps;
+            if (!plegar) vaciarLote();
+            if (!plegar) {
+                TramaMap::ejecutar(t.desplazamiento, carga, rotor);
+                ++rotaciones;
+                break;
+            }
+            {
+                int tam = rotor->getTamano();
+                int d = t.desplazamiento % tam;
+                if (d < 0) d += tam;
+                pendiente += d;
+                if (pendiente >= tam) pendiente -= tam;
+            }
+            if (traza()) {
+                std::cout << "Trama: [M," << t.desplazamiento << "] -> Procesando... "
+                          << " -> rotación diferida (neta pendiente: +" << pendiente << ")\n";
+            }
+            break;
+        default:
+            ++invalidas;
+            break;
+        }
+    }
+
+    /**
+     * @brief Procesa una trama polimórfica
+     * @param t Trama creada por parseLinea()
+     * @details No pliega: la trama decide qué hacer con carga y rotor
+     */
+    void procesar(TramaBase* t) {
+        vaciarLote();
+        aplicarPendiente();
+        long antes = carga->getLongitud();
+        t->procesar(carga, rotor);
+        if (carga->getLongitud() > antes) {
+            ++loads;
+        } else {
+            ++maps;
+            ++rotaciones;
+        }
+    }
+
+    /**
+     * @brief Suma contadores de tramas procesadas fuera de este decodificador
+     * @param l Tramas LOAD
+     * @param m Tramas MAP
+     * @param inv Líneas descartadas
+     * @param rot Rotaciones aplicadas
+     * @details Usado al combinar el trabajo de varios hilos
+     */
+    void acumular(long l, long m, long inv, long rot) {
+        loads += l;
+        maps += m;
+        invalidas += inv;
+        rotaciones += rot;
+    }
+
+    /**
+     * @brief Registra una línea descartada por el parser
+     */
+    void registrarInvalida() { ++invalidas; }
+
+    /**
+     * @brief Termina la sesión dejando el rotor en su estado final
+     */
+    void finalizar() {
+        vaciarLote();
+        aplicarPendiente();
+    }
+
+    /**
+     * @brief Posición del rotor contando la rotación pendiente del plegado
+     * @return Desplazamiento que tendrá el rotor para el siguiente LOAD
+     */
+    int getPosicionRotor() const {
+        return (rotor->getOffset() + pendiente) % rotor->getTamano();
+    }
+
+    /**
+     * @brief Tramas LOAD procesadas
+     * @return Contador de LOAD
+     */
+    long getLoads() const { return loads; }
+
+    /**
+     * @brief Tramas MAP procesadas
+     * @return Contador de MAP
+     */
+    long getMaps() const { return maps; }
+
+    /**
+     * @brief Líneas descartadas
+     * @return Contador de tramas inválidas
+     */
+    long getInvalidas() const { return invalidas; }
+
+    /**
+     * @brief Rotaciones aplicadas efectivamente al rotor
+     * @return Con plegado, menor o igual que getMaps()
+     */
+    long getRotaciones() const { return rotaciones; }
+};
+
+#endif // PRT7_DECODIFICADOR_H
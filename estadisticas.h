@@ -0,0 +1,304 @@
+/**
+ * @file estadisticas.h
+ * @brief Contadores e histogramas de latencia del decodificador
+ *
+ * @details
+ * Instrumentación opcional del bucle principal (--stats, --stats-json).
+ * Cuando está desactivada, el bucle solo comprueba un puntero nulo por
+ * trama. Cuando está activa, cada trama registra su tipo, el tamaño de la
+ * línea y el tiempo de parseo, de procesamiento y de salida en
+ * histogramas logarítmicos de base 2.
+ */
+
+#ifndef PRT7_ESTADISTICAS_H
+#define PRT7_ESTADISTICAS_H
+
+#include <cstdio>
+#include <cstddef>
+
+#include "estructuras.h"
+#include "tramas.h"
+#include "decodificador.h"
+#include "binario.h"
+
+/**************************************************************************
+ * @struct HistogramaLog2
+ * @brief Histograma con cubetas [2^i, 2^(i+1))
+ **************************************************************************/
+struct HistogramaLog2 {
+    static const int CUBETAS = 40;   ///< Cubre valores hasta 2^40 (unos 18 minutos en ns)
+    long cuenta[CUBETAS];            ///< Muestras por cubeta
+    long n;                          ///< Total de muestras
+    long long suma;                  ///< Suma de las muestras
+    long long maximo;                ///< Mayor muestra
+
+    /**
+     * @brief Constructor - histograma vacío
+     */
+    HistogramaLog2() : n(0), suma(0), maximo(0) {
+        for (int i = 0; i < CUBETAS; ++i) cuenta[i] = 0;
+    }
+
+    /**
+     * @brief Registra una muestra
+     * @param v Valor (negativos cuentan como 0)
+     */
+    void registrar(long long v) {
+        if (v < 0) v = 0;
+        int i = 0;
+        for (unsigned long long x = (unsigned long long)v >> 1; x && i < CUBETAS - 1; x >>= 1) ++i;
+        ++cuenta[i];
+        ++n;
+        suma += v;
+        if (v > maximo) maximo = v;
+    }
+
+    /**
+     * @brief Media de las muestras
+     * @return Media, o 0 si no hay muestras
+     */
+    double media() const { return n ? (double)suma / (double)n : 0.0; }
+
+    /**
+     * @brief Aproxima un percentil con el límite superior de su cubeta
+     * @param p Fracción (0..1)
+     * @return Cota superior del percentil
+     */
+    long long percentil(double p) const {
+        long objetivo = (long)(p * (double)n);
+        long acumulado = 0;
+        for (int i = 0; i < CUBETAS; ++i) {
+            acumulado += cuenta[i];
+            if (acumulado > objetivo) return 1LL << (i + 1);
+        }
+        return maximo;
+    }
+
+    /**
+     * @brief Escribe el histograma como objeto JSON
+     * @param f Archivo de salida
+     */
+    void escribirJson(FILE* f) const {
+        fprintf(f, "{\"n\": %ld, \"media\": %.1f, \"max\": %lld, \"p50\": %lld, \"p99\": %lld, \"cubetas\": [",
+                n, media(), maximo, percentil(0.5), percentil(0.99));
+        bool primero = true;
+        for (int i = 0; i < CUBETAS; ++i) {
+            if (!cuenta[i]) continue;
+            fprintf(f, "%s[%lld, %ld]", primero ? "" : ", ", 1LL << (i + 1), cuenta[i]);
+            primero = false;
+        }
+        fprintf(f, "]}");
+    }
+};
+
+/**************************************************************************
+ * @class Estadisticas
+ * @brief Contadores del bucle de decodificación y su publicación
+ *
+ * @details
+ * Los contadores por tipo y los histogramas se alimentan desde el bucle
+ * principal. Las rotaciones y el estado de las listas de carga se leen de
+ * los decodificadores observados (uno por flujo en --multi) al informar.
+ **************************************************************************/
+class Estadisticas {
+private:
+    long long inicioNs;              ///< Inicio de la sesión
+    long long ultimoInformeNs;       ///< Momento de la última línea periódica
+    long long periodoNs;             ///< Periodo de la línea periódica (0 = solo al final)
+    long tramasUltimoInforme;        ///< Tramas contadas en la última línea periódica
+    long loads;                      ///< Tramas LOAD
+    long maps;                       ///< Tramas MAP
+    long invalidas;                  ///< Líneas descartadas
+    long long bytes;                 ///< Bytes de las líneas recibidas (con su '\n')
+    HistogramaLog2 parseo;           ///< ns de parseo por trama
+    HistogramaLog2 proceso;          ///< ns de Decodificador::procesar() por trama
+    HistogramaLog2 salida;           ///< ns de salida (traza y mensaje final)
+    HistogramaLog2 largoLinea;       ///< Bytes por línea (o por bloque binario)
+    const Decodificador** decos;     ///< Decodificadores observados
+    const ListaDeCarga** cargas;     ///< Listas de carga observadas
+    int observados;                  ///< Fuentes observadas
+    int capacidadObservados;         ///< Tamaño de los arreglos de observados
+    const char* rutaJson;            ///< Destino de volcarJson() (nullptr = stderr)
+
+    /**
+     * @brief Suma las rotaciones y el estado de las listas observadas
+     * @param rotaciones Recibe el total de rotaciones aplicadas
+     * @param longitud Recibe el total de fragmentos almacenados
+     * @param memoria Recibe los bytes reservados por las listas
+     */
+    void totales(long& rotaciones, long& longitud, size_t& memoria) const {
+        rotaciones = longitud = 0;
+        memoria = 0;
+        for (int i = 0; i < observados; ++i) {
+            rotaciones += decos[i]->getRotaciones();
+            longitud += cargas[i]->getLongitud();
+            memoria += cargas[i]->getMemoria();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param periodoSeg Segundos entre líneas periódicas (0 = solo al final)
+     * @param json Archivo del volcado JSON, o nullptr para stderr
+     */
+    Estadisticas(double periodoSeg, const char* json)
+        : inicioNs(relojNs()), ultimoInformeNs(0), periodoNs((long long)(periodoSeg * 1e9)),
+          tramasUltimoInforme(0), loads(0), maps(0), invalidas(0), bytes(0),
+          decos(nullptr), cargas(nullptr), observados(0), capacidadObservados(0),
+          rutaJson(json) {
+        ultimoInformeNs = inicioNs;
+    }
+
+    /**
+     * @brief Destructor
+     */
+    ~Estadisticas() {
+        delete[] decos;
+        delete[] cargas;
+    }
+
+    /**
+     * @brief Agrega un decodificador y su lista a los totales
+     * @param d Decodificador de un flujo
+     * @param c Lista de carga del mismo flujo
+     */
+    void observar(const Decodificador* d, const ListaDeCarga* c) {
+        if (observados == capacidadObservados) {
+            int nueva = capacidadObservados ? 2 * capacidadObservados : 4;
+            const Decodificador** nd = new const Decodificador*[nueva];
+            const ListaDeCarga** nc = new const ListaDeCarga*[nueva];
+            for (int i = 0; i < observados; ++i) {
+                nd[i] = decos[i];
+                nc[i] = cargas[i];
+            }
+            delete[] decos;
+            delete[] cargas;
+            decos = nd;
+            cargas = nc;
+            capacidadObservados = nueva;
+        }
+        decos[observados] = d;
+        cargas[observados] = c;
+        ++observados;
+    }
+
+    /**
+     * @brief Registra una trama procesada
+     * @param tipo Tipo resultante del parseo
+     * @param nsParseo Tiempo de parseo
+     * @param nsProceso Tiempo de procesamiento (ignorado en las inválidas)
+     */
+    void registrarTrama(TipoTrama tipo, long long nsParseo, long long nsProceso) {
+        if (tipo == TRAMA_LOAD) ++loads;
+        else if (tipo == TRAMA_MAP) ++maps;
+        else ++invalidas;
+        parseo.registrar(nsParseo);
+        if (tipo != TRAMA_INVALIDA) proceso.registrar(nsProceso);
+    }
+
+    /**
+     * @brief Registra una línea de texto recibida
+     * @param largo Bytes de la línea (sin '\n')
+     */
+    void registrarLinea(size_t largo) {
+        bytes += (long long)largo + 1;
+        largoLinea.registrar((long long)largo);
+    }
+
+    /**
+     * @brief Registra un bloque binario recibido
+     * @param largo Bytes de registros del bloque
+     */
+    void registrarBloque(size_t largo) {
+        bytes += (long long)(largo + BIN_CABECERA + 1);
+        largoLinea.registrar((long long)largo);
+    }
+
+    /**
+     * @brief Registra tiempo de salida (traza o mensaje final)
+     * @param ns Nanosegundos
+     */
+    void registrarSalida(long long ns) { salida.registrar(ns); }
+
+    /**
+     * @brief Suma contadores de tramas procesadas sin instrumentar (p. ej. en hilos)
+     * @param l Tramas LOAD
+     * @param m Tramas MAP
+     * @param inv Líneas descartadas
+     */
+    void acumular(long l, long m, long inv) {
+        loads += l;
+        maps += m;
+        invalidas += inv;
+    }
+
+    /**
+     * @brief Indica si ya corresponde la línea periódica
+     * @return true si pasó el periodo configurado
+     */
+    bool tocaInforme() const {
+        return periodoNs > 0 && relojNs() - ultimoInformeNs >= periodoNs;
+    }
+
+    /**
+     * @brief Escribe la línea de estado en stderr
+     * @details Las tasas son las del intervalo desde la línea anterior
+     */
+    void imprimirLinea() {
+        long long ahora = relojNs();
+        long tramas = loads + maps + invalidas;
+        double intervalo = (double)(ahora - ultimoInformeNs) / 1e9;
+        double tasa = intervalo > 0 ? (double)(tramas - tramasUltimoInforme) / intervalo : 0.0;
+        long rotaciones, longitud;
+        size_t memoria;
+        totales(rotaciones, longitud, memoria);
+        fprintf(stderr,
+                "stats: %.1f s, %ld tramas (%.0f/s; LOAD %ld, MAP %ld, inválidas %ld), %lld B, "
+                "rotaciones %ld, carga %ld (%zu B), media ns parseo %.0f / procesar %.0f / salida %.0f\n",
+                (double)(ahora - inicioNs) / 1e9, tramas, tasa, loads, maps, invalidas, bytes,
+                rotaciones, longitud, memoria, parseo.media(), proceso.media(), salida.media());
+        ultimoInformeNs = ahora;
+        tramasUltimoInforme = tramas;
+    }
+
+    /**
+     * @brief Indica si hay archivo configurado para el volcado JSON
+     * @return true si se indicó --stats-json
+     */
+    bool tieneDestinoJson() const { return rutaJson != nullptr; }
+
+    /**
+     * @brief Escribe todos los contadores como JSON
+     * @return false si no se pudo escribir el archivo
+     * @details El archivo configurado se reemplaza en cada volcado
+     */
+    bool volcarJson() const {
+        const char* ruta = rutaJson;
+        FILE* f = ruta ? fopen(ruta, "w") : stderr;
+        if (!f) return false;
+        double seg = (double)(relojNs() - inicioNs) / 1e9;
+        long tramas = loads + maps + invalidas;
+        long rotaciones, longitud;
+        size_t memoria;
+        totales(rotaciones, longitud, memoria);
+        fprintf(f, "{\n  \"segundos\": %.3f,\n  \"tramas\": %ld,\n  \"tramas_por_s\": %.1f,\n",
+                seg, tramas, seg > 0 ? (double)tramas / seg : 0.0);
+        fprintf(f, "  \"load\": %ld,\n  \"map\": %ld,\n  \"invalidas\": %ld,\n", loads, maps, invalidas);
+        fprintf(f, "  \"bytes\": %lld,\n  \"rotaciones\": %ld,\n", bytes, rotaciones);
+        fprintf(f, "  \"carga\": {\"longitud\": %ld, \"memoria_bytes\": %zu},\n", longitud, memoria);
+        fprintf(f, "  \"bytes_por_linea\": ");
+        largoLinea.escribirJson(f);
+        fprintf(f, ",\n  \"ns_parseo\": ");
+        parseo.escribirJson(f);
+        fprintf(f, ",\n  \"ns_procesar\": ");
+        proceso.escribirJson(f);
+        fprintf(f, ",\n  \"ns_salida\": ");
+        salida.escribirJson(f);
+        fprintf(f, "\n}\n");
+        if (!ruta) return true;
+        return fclose(f) == 0;
+    }
+};
+
+#endif // PRT7_ESTADISTICAS_H
@@ -0,0 +1,1220 @@
+/**
+ * @file estructuras.h
+ * @brief Estructuras de datos del decodificador PRT-7
+ * 
+ * @details
+ * Nodos, lista doblemente enlazada de carga (ListaDeCarga) y rotores de
+ * mapeo: la lista circular del caso de estudio (RotorDeMapeo) y el rotor
+ * por tabla RotorAlfabeto, especializado en compilación para cada alfabeto
+ * (RotorTabla es el de A-Z).
+ */
+
+#ifndef PRT7_ESTRUCTURAS_H
+#define PRT7_ESTRUCTURAS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <time.h>
+#else
+#include <chrono>
+#endif
+
+#include "patrones.h"
+
+/**************************************************************************
+ * Declaraciones adelantadas
+ **************************************************************************/
+class ListaDeCarga;
+class RotorDeMapeo;
+struct AlfabetoLatino;
+struct AlfabetoAlfanumerico;
+template <class Alfabeto> class RotorAlfabeto;
+
+/**
+ * @typedef RotorTabla
+ * @brief Rotor por tabla del protocolo original (A-Z)
+ */
+typedef RotorAlfabeto<AlfabetoLatino> RotorTabla;
+
+/**
+ * @enum Verbosidad
+ * @brief Nivel de detalle de la salida por consola
+ */
+enum Verbosidad {
+    VERB_SILENCIO,       ///< Solo el mensaje ensamblado al final
+    VERB_RESUMEN,        ///< Mensaje final y contadores de tramas
+    VERB_TRAZA           ///< Detalle de cada trama (comportamiento original)
+};
+
+/**
+ * @typedef RotorActivo
+ * @brief Rotor usado por las tramas para decodificar
+ * @details Con PRT7_CURSO se usa la lista circular RotorDeMapeo exigida por
+ * el caso de estudio; con PRT7_ALFANUMERICO, el rotor por tabla de A-Z0-9
+ * del firmware extendido; en otro caso, el rotor por tabla RotorTabla (O(1)).
+ */
+#ifdef PRT7_CURSO
+typedef RotorDeMapeo RotorActivo;
+#elif defined(PRT7_ALFANUMERICO)
+typedef RotorAlfabeto<AlfabetoAlfanumerico> RotorActivo;
+#else
+typedef RotorTabla RotorActivo;
+#endif
+
+/**
+ * @brief Tiempo monótono actual en nanosegundos
+ * @return Nanosegundos desde un origen arbitrario
+ */
+inline long long relojNs() {
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#else
+    return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**************************************************************************
+ * Estructuras de Nodos
+ **************************************************************************/
+
+/**
+ * @struct NodoCarga
+ * @brief Nodo para la lista doblemente enlazada de fragmentos decodificados
+ */
+struct NodoCarga {
+    char dato;           ///< Carácter decodificado almacenado
+    NodoCarga* prev;     ///< Puntero al nodo anterior
+    NodoCarga* next;     ///< Puntero al nodo siguiente
+    
+    /**
+     * @brief Constructor del nodo
+     * @param d Carácter a almacenar
+     */
+    NodoCarga(char d) : dato(d), prev(nullptr), next(nullptr) {}
+
+    /**
+     * @brief Constructor por defecto (nodos reservados en bloque)
+     */
+    NodoCarga() : dato(0), prev(nullptr), next(nullptr) {}
+};
+
+/**
+ * @struct BloqueCarga
+ * @brief Bloque contiguo de nodos del que la ListaDeCarga toma sus nodos
+ * 
+ * @details
+ * En modo arena los nodos se reparten secuencialmente desde bloques grandes
+ * en lugar de un new por carácter; los bloques se liberan juntos al destruir
+ * la lista.
+ */
+struct BloqueCarga {
+    static const int CAPACIDAD = 4096;   ///< Nodos por bloque
+    NodoCarga nodos[CAPACIDAD];          ///< Almacenamiento contiguo de nodos
+    BloqueCarga* sig;                    ///< Bloque reservado anteriormente
+
+    /**
+     * @brief Constructor
+     * @param anterior Bloque anterior en la cadena de bloques
+     */
+    BloqueCarga(BloqueCarga* anterior) : sig(anterior) {}
+};
+
+/**
+ * @struct NodoRotor
+ * @brief Nodo para la lista circular del rotor de mapeo
+ */
+struct NodoRotor {
+    char c;              ///< Carácter del alfabeto (A-Z)
+    NodoRotor* prev;     ///< Puntero al nodo anterior (circular)
+    NodoRotor* next;     ///< Puntero al nodo siguiente (circular)
+    
+    /**
+     * @brief Constructor del nodo
+     * @param ch Carácter del alfabeto
+     */
+    NodoRotor(char ch) : c(ch), prev(nullptr), next(nullptr) {}
+};
+
+/**************************************************************************
+ * @class ListaDeCarga
+ * @brief Lista doblemente enlazada para almacenar fragmentos decodificados
+ * 
+ * @details
+ * Implementación manual (sin STL) de una lista doblemente enlazada que
+ * mantiene el orden de los fragmentos de mensaje a medida que se decodifican.
+ *
+ * En modo flujo (configurarFlujo) cada fragmento se copia además a un
+ * buffer que se escribe en el destino en bloques grandes, y la lista solo
+ * retiene los últimos fragmentos (la ventana); los nodos que salen por la
+ * cabeza se reciclan para los siguientes, así que la memoria no crece con
+ * la duración de la sesión.
+ *
+ * En modo anillo (configurarAnillo) la lista tiene capacidad fija: todos
+ * sus nodos se reservan juntos al configurarla y, una vez llena, cada
+ * fragmento nuevo reutiliza el nodo del más antiguo. Los enlaces prev/next
+ * se conservan, así que se recorre igual en ambos sentidos, y en régimen
+ * estable no se reserva memoria.
+ *
+ * Con permitirLecturaConcurrente() el hilo que decodifica publica tras
+ * cada inserción la cola y el número de nodos al estilo seqlock, y otros
+ * hilos pueden copiar el mensaje parcial (copiarInstantanea(),
+ * copiarUltimos()) sin tomar cerrojos ni frenar al escritor: los nodos
+ * anteriores a la cola publicada ya no cambian. Por eso no es compatible
+ * con los modos que reciclan nodos (flujo, anillo, extraer()).
+ **************************************************************************/
+class ListaDeCarga {
+private:
+    NodoCarga* head;     ///< Puntero al primer nodo
+    NodoCarga* tail;     ///< Puntero al último nodo
+    long longitud;       ///< Número de fragmentos recibidos
+    long retenidos;      ///< Nodos en la lista (== longitud fuera del modo flujo)
+    bool incremental;    ///< Si es true, cada LOAD imprime solo el fragmento nuevo
+    long cadaK;          ///< Periodo (en fragmentos) de la instantánea completa; 0 = nunca
+    bool instantaneaPendiente; ///< Instantánea completa solicitada bajo demanda
+    Verbosidad nivel;    ///< Nivel de detalle de imprimirProgreso()
+    bool usarArena;      ///< Si es true, los nodos se toman de bloques contiguos
+    BloqueCarga* bloques;  ///< Bloque actual (enlaza a los anteriores)
+    int usadosBloque;    ///< Nodos ya repartidos del bloque actual
+    NodoCarga* libres;   ///< Nodos reciclados disponibles (enlazados por next)
+    long nLibres;        ///< Nodos en libres
+    char* flujo;         ///< Buffer del modo flujo (nullptr = mensaje completo en memoria)
+    size_t enFlujo;      ///< Bytes pendientes en flujo
+    FILE* destino;       ///< Destino del modo flujo (stdout se escribe por std::cout)
+    long ventana;        ///< Nodos retenidos en modo flujo o capacidad del anillo
+    NodoCarga* anillo;   ///< Nodos del modo anillo (nullptr = sin límite de capacidad)
+    BuscadorPatrones* buscador;  ///< Palabras clave a vigilar (nullptr = ninguna)
+    bool publicar;       ///< Publicar la cola para lectores concurrentes
+    std::atomic<unsigned long> secuencia;        ///< Impar mientras se publica
+    std::atomic<const NodoCarga*> colaPublicada; ///< Último nodo visible para los lectores
+    std::atomic<long> nodosPublicados;           ///< Nodos hasta colaPublicada inclusive
+
+    static const size_t TAM_FLUJO = 1 << 16;  ///< Bytes por escritura en modo flujo
+
+    /**
+     * @brief Obtiene un nodo nuevo según el modo de almacenamiento
+     * @param dato Carácter a almacenar
+     * @return Nodo inicializado y sin enlazar
+     */
+    NodoCarga* nuevoNodo(char dato) {
+        if (libres) {
+            NodoCarga* n = libres;
+            libres = n->next;
+            --nLibres;
+            n->dato = dato;
+            n->prev = n->next = nullptr;
+            return n;
+        }
+        if (!usarArena) return new NodoCarga(dato);
+        if (!bloques || usadosBloque == BloqueCarga::CAPACIDAD) {
+            bloques = new BloqueCarga(bloques);
+            usadosBloque = 0;
+        }
+        NodoCarga* n = &bloques->nodos[usadosBloque++];
+        n->dato = dato;
+        return n;
+    }
+
+    /**
+     * @brief Enlaza un nodo nuevo al final y aplica la ventana del modo flujo
+     * @param dato Carácter a almacenar
+     * @post No cuenta el fragmento en longitud (lo hace el llamador)
+     */
+    void enlazar(char dato) {
+        // En el anillo el nodo más antiguo se libera antes: nunca se pide memoria
+        if (anillo && retenidos == ventana) reciclarCabeza();
+        NodoCarga* n = nuevoNodo(dato);
+        if (!tail) {
+            head = tail = n;
+        } else {
+            tail->next = n;
+            n->prev = tail;
+            tail = n;
+        }
+        ++retenidos;
+        if (flujo && retenidos > ventana) reciclarCabeza();
+        if (publicar) publicarCola();
+    }
+
+    /**
+     * @brief Publica tail y retenidos para los lectores concurrentes (escritor)
+     * @details Los enlaces de los nodos se escribieron antes; la liberación
+     * del último incremento de secuencia los hace visibles junto con la cola.
+     */
+    void publicarCola() {
+        unsigned long s = secuencia.load(std::memory_order_relaxed);
+        secuencia.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        colaPublicada.store(tail, std::memory_order_relaxed);
+        nodosPublicados.store(retenidos, std::memory_order_relaxed);
+        secuencia.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Lee un par cola/nodos publicado de forma consistente (lector)
+     * @param cola Recibe el último nodo visible (nullptr si la lista está vacía)
+     * @param nodos Recibe los nodos desde head hasta cola inclusive
+     * @details Si el escritor está publicando, se reintenta: la publicación
+     * son unas pocas escrituras, así que el escritor nunca espera.
+     */
+    void leerPublicado(const NodoCarga*& cola, long& nodos) const {
+        for (;;) {
+            unsigned long s = secuencia.load(std::memory_order_acquire);
+            if (s & 1) continue;
+            cola = colaPublicada.load(std::memory_order_relaxed);
+            nodos = nodosPublicados.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (secuencia.load(std::memory_order_relaxed) == s) return;
+        }
+    }
+
+    /**
+     * @brief Saca el primer nodo de la lista y lo deja para reutilizarlo
+     */
+    void reciclarCabeza() {
+        NodoCarga* n = head;
+        head = n->next;
+        if (head) head->prev = nullptr;
+        else tail = nullptr;
+        n->next = libres;
+        libres = n;
+        ++nLibres;
+        --retenidos;
+    }
+
+    /**
+     * @brief Indica si un nodo forma parte del almacenamiento del anillo
+     * @param n Nodo de la lista o de libres
+     * @return true si lo liberará delete[] anillo
+     */
+    bool esDelAnillo(const NodoCarga* n) const {
+        return anillo && n >= anillo && n < anillo + ventana;
+    }
+
+    /**
+     * @brief Cuerpo de insertarAlFinal() sin pasar por el buscador
+     * @param dato Carácter a insertar
+     */
+    void agregar(char dato) {
+        if (flujo) {
+            flujo[enFlujo++] = dato;
+            if (enFlujo == TAM_FLUJO) vaciarFlujo();
+        }
+        enlazar(dato);
+        ++longitud;
+    }
+
+    /**
+     * @brief Copia caracteres al buffer del modo flujo, escribiéndolo al llenarse
+     * @param datos Caracteres decodificados
+     * @param n Número de caracteres
+     */
+    void escribirFlujo(const char* datos, size_t n) {
+        while (n > 0) {
+            size_t k = TAM_FLUJO - enFlujo;
+            if (k > n) k = n;
+            memcpy(flujo + enFlujo, datos, k);
+            enFlujo += k;
+            datos += k;
+            n -= k;
+            if (enFlujo == TAM_FLUJO) vaciarFlujo();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param arena true para reservar los nodos en bloques contiguos
+     * @post Lista vacía inicializada, salida en modo completo
+     */
+#ifdef PRT7_CURSO
+    ListaDeCarga(bool arena = false)
+#else
+    ListaDeCarga(bool arena = true)
+#endif
+        : head(nullptr), tail(nullptr), longitud(0), retenidos(0),
+          incremental(false), cadaK(0), instantaneaPendiente(false),
+          nivel(VERB_TRAZA), usarArena(arena), bloques(nullptr), usadosBloque(0),
+          libres(nullptr), nLibres(0), flujo(nullptr), enFlujo(0), destino(nullptr),
+          ventana(0), anillo(nullptr), buscador(nullptr), publicar(false), secuencia(0),
+          colaPublicada(nullptr), nodosPublicados(0) {}
+    
+    /**
+     * @brief Destructor - libera toda la memoria de los nodos
+     * @details En modo arena libera los bloques completos; en otro caso
+     * recorre la lista y elimina cada nodo individualmente. Los bytes del
+     * modo flujo que no se hayan vaciado se descartan: el destino puede estar
+     * ya cerrado (ver imprimirMensajeFinal()).
+     */
+    ~ListaDeCarga() {
+        delete[] flujo;
+        if (usarArena) {
+            while (bloques) {
+                BloqueCarga* sig = bloques->sig;
+                delete bloques;
+                bloques = sig;
+            }
+            delete[] anillo;
+            return;
+        }
+        NodoCarga* cur = head;
+        while (cur) {
+            NodoCarga* nx = cur->next;
+            if (!esDelAnillo(cur)) delete cur;
+            cur = nx;
+        }
+        while (libres) {
+            NodoCarga* nx = libres->next;
+            if (!esDelAnillo(libres)) delete libres;
+            libres = nx;
+        }
+        delete[] anillo;
+    }
+
+    /**
+     * @brief Activa el modo flujo: el mensaje se escribe a medida que llega
+     * @param f Destino abierto (archivo, tubería o stdout); no pasa a ser
+     * propiedad de la lista
+     * @param nodos Fragmentos que se retienen para la vista previa (al menos 1)
+     * @details Con f == stdout las escrituras pasan por std::cout para
+     * conservar el orden respecto del resto de la salida.
+     */
+    void configurarFlujo(FILE* f, long nodos) {
+        if (publicar) return;
+        if (!flujo) flujo = new char[TAM_FLUJO];
+        destino = f;
+        ventana = (nodos > 0 ? nodos : 1);
+        while (retenidos > ventana) reciclarCabeza();
+    }
+
+    /**
+     * @brief Activa el modo anillo: solo se conservan los últimos fragmentos
+     * @param capacidad Fragmentos que caben en la lista (al menos 1)
+     * @pre La lista está vacía y no está en modo flujo
+     * @post Los capacidad nodos quedan reservados de una vez; los fragmentos
+     * siguientes no reservan memoria
+     */
+    void configurarAnillo(long capacidad) {
+        if (anillo || head || flujo || publicar) return;
+        ventana = (capacidad > 0 ? capacidad : 1);
+        anillo = new NodoCarga[ventana];
+        for (long i = ventana - 1; i >= 0; --i) {
+            anillo[i].next = libres;
+            libres = &anillo[i];
+        }
+        nLibres += ventana;
+    }
+
+    /**
+     * @brief Indica si la lista está en modo anillo
+     * @return true tras configurarAnillo()
+     */
+    bool enModoAnillo() const { return anillo != nullptr; }
+
+    /**
+     * @brief Activa la publicación de la cola para lectores concurrentes
+     * @return false en modo flujo o anillo, o si extraer() ya recicló nodos
+     * @post Desde aquí configurarFlujo(), configurarAnillo() y extraer() no
+     * hacen nada
+     */
+    bool permitirLecturaConcurrente() {
+        if (flujo || anillo || libres) return false;
+        publicar = true;
+        publicarCola();
+        return true;
+    }
+
+    /**
+     * @brief Copia los primeros fragmentos del mensaje publicado (cualquier hilo)
+     * @param buf Destino
+     * @param cap Bytes disponibles en buf
+     * @return Fragmentos publicados en el momento de la copia (puede ser más que cap)
+     * @pre permitirLecturaConcurrente() devolvió true
+     * @details No bloquea al hilo que decodifica; la copia corresponde a
+     * una publicación completa aunque este siga insertando.
+     */
+    long copiarInstantanea(char* buf, size_t cap) const {
+        const NodoCarga* cola;
+        long nodos;
+        leerPublicado(cola, nodos);
+        size_t k = (size_t)nodos < cap ? (size_t)nodos : cap;
+        if (k == 0) return nodos;
+        // head ya es visible: se escribió antes de la primera publicación
+        const NodoCarga* cur = primero();
+        for (size_t i = 0; i < k; ++i) {
+            buf[i] = cur->dato;
+            // El next de la cola puede estar escribiéndose: no se lee
+            if (i + 1 < k) cur = cur->next;
+        }
+        return nodos;
+    }
+
+    /**
+     * @brief Copia los últimos fragmentos del mensaje publicado (cualquier hilo)
+     * @param buf Destino
+     * @param n Fragmentos a copiar como máximo
+     * @param total Recibe los fragmentos publicados en el momento de la copia
+     * @return Fragmentos copiados (los últimos min(n, total), en orden)
+     * @pre permitirLecturaConcurrente() devolvió true
+     * @details Recorre hacia atrás desde la cola publicada: cuesta O(n)
+     * aunque el mensaje sea largo.
+     */
+    size_t copiarUltimos(char* buf, size_t n, long& total) const {
+        const NodoCarga* cur;
+        leerPublicado(cur, total);
+        size_t k = (size_t)total < n ? (size_t)total : n;
+        for (size_t i = k; i > 0; --i) {
+            buf[i - 1] = cur->dato;
+            if (i > 1) cur = cur->prev;
+        }
+        return k;
+    }
+
+    /**
+     * @brief Cuenta como recibidos fragmentos escritos en una sesión anterior
+     * @param n Fragmentos que ya están en el destino del modo flujo
+     * @details Usado al reanudar desde un punto de control (--resume): el
+     * contador continúa sin volver a cargar el mensaje en la lista.
+     */
+    void fijarLongitudPrevia(long n) { longitud = retenidos + (n > 0 ? n : 0); }
+
+    /**
+     * @brief Indica si la lista está en modo flujo
+     * @return true tras configurarFlujo()
+     */
+    bool enModoFlujo() const { return flujo != nullptr; }
+
+    /**
+     * @brief Escribe en el destino los fragmentos pendientes del modo flujo
+     */
+    void vaciarFlujo() {
+        if (!flujo || enFlujo == 0) return;
+        if (destino == stdout) {
+            std::cout.write(flujo, (std::streamsize)enFlujo);
+            std::cout.flush();
+        } else {
+            fwrite(flujo, 1, enFlujo, destino);
+            fflush(destino);
+        }
+        enFlujo = 0;
+    }
+
+    /**
+     * @brief Vigila palabras clave en los fragmentos que se inserten
+     * @param b Autómata compilado (no pasa a ser propiedad de la lista), o
+     * nullptr para dejar de vigilar
+     */
+    void vigilar(BuscadorPatrones* b) { buscador = b; }
+
+    /**
+     * @brief Inserta un carácter al final de la lista
+     * @param dato Carácter a insertar
+     * @post El carácter se agrega al final, manteniendo el orden de llegada
+     */
+    void insertarAlFinal(char dato) {
+        if (buscador) buscador->alimentar(dato, longitud);
+        agregar(dato);
+    }
+
+    /**
+     * @brief Inserta varios caracteres al final de la lista
+     * @param datos Caracteres a insertar, en orden
+     * @param n Número de caracteres
+     * @post Equivale a n llamadas a insertarAlFinal()
+     * @details En modo arena enlaza los nodos de cada bloque en un solo
+     * recorrido, sin pasar por nuevoNodo() en cada carácter. En modo flujo
+     * o anillo solo se enlazan los caracteres que caben en la ventana.
+     */
+    void insertarBloque(const char* datos, size_t n) {
+        if (buscador) buscador->alimentar(datos, n, longitud);
+        if (flujo || anillo) {
+            if (flujo) escribirFlujo(datos, n);
+            size_t omitidos = (n > (size_t)ventana ? n - (size_t)ventana : 0);
+            for (size_t i = omitidos; i < n; ++i) enlazar(datos[i]);
+            longitud += (long)n;
+            return;
+        }
+        // Con nodos reciclados (ver extraer()) se reutilizan antes que la arena
+        if (!usarArena || libres) {
+            for (size_t i = 0; i < n; ++i) agregar(datos[i]);
+            return;
+        }
+        size_t i = 0;
+        while (i < n) {
+            if (!bloques || usadosBloque == BloqueCarga::CAPACIDAD) {
+                bloques = new BloqueCarga(bloques);
+                usadosBloque = 0;
+            }
+            size_t libres = (size_t)(BloqueCarga::CAPACIDAD - usadosBloque);
+            size_t k = (n - i < libres ? n - i : libres);
+            NodoCarga* n0 = &bloques->nodos[usadosBloque];
+            NodoCarga* prev = tail;
+            for (size_t j = 0; j < k; ++j) {
+                NodoCarga* nd = n0 + j;
+                nd->dato = datos[i + j];
+                nd->prev = prev;
+                nd->next = nullptr;
+                if (prev) prev->next = nd;
+                prev = nd;
+            }
+            if (!head) head = n0;
+            tail = prev;
+            usadosBloque += (int)k;
+            longitud += (long)k;
+            retenidos += (long)k;
+            i += k;
+        }
+        if (publicar) publicarCola();
+    }
+
+    /**
+     * @brief Retira los primeros fragmentos de la lista copiándolos a un buffer
+     * @param buf Destino
+     * @param cap Bytes disponibles en buf
+     * @return Fragmentos copiados y retirados
+     * @details Los nodos retirados se reciclan para los próximos fragmentos,
+     * así que un consumidor que extrae a medida que se decodifica mantiene la
+     * memoria acotada. getLongitud() sigue contando los fragmentos retirados.
+     * Con lectores concurrentes (permitirLecturaConcurrente()) no retira nada.
+     */
+    size_t extraer(char* buf, size_t cap) {
+        if (publicar) return 0;
+        size_t n = 0;
+        while (head && n < cap) {
+            buf[n++] = head->dato;
+            reciclarCabeza();
+        }
+        return n;
+    }
+
+    /**
+     * @brief Devuelve el número de fragmentos recibidos
+     * @return Longitud actual del mensaje (en modo flujo, incluye los ya escritos)
+     */
+    long getLongitud() const { return longitud; }
+
+    /**
+     * @brief Devuelve el número de nodos presentes en la lista
+     * @return Igual a getLongitud() salvo en modo flujo o anillo, donde no
+     * pasa de la ventana
+     */
+    long getRetenidos() const { return retenidos; }
+
+    /**
+     * @brief Memoria reservada para los nodos
+     * @return Bytes de los bloques de la arena, o de los nodos individuales
+     * (sin contar la sobrecarga del asignador)
+     */
+    size_t getMemoria() const {
+        if (!usarArena) return (size_t)(retenidos + nLibres) * sizeof(NodoCarga);
+        size_t total = anillo ? (size_t)ventana * sizeof(NodoCarga) : 0;
+        for (const BloqueCarga* b = bloques; b; b = b->sig) total += sizeof(BloqueCarga);
+        return total;
+    }
+
+    /**
+     * @brief Indica si los nodos se reservan en bloques contiguos
+     * @return true en modo arena
+     */
+    bool usaArena() const { return usarArena; }
+
+    /**
+     * @brief Devuelve el primer nodo para recorrer la lista
+     * @return Puntero al primer nodo (nullptr si está vacía)
+     */
+    const NodoCarga* primero() const { return head; }
+
+    /**
+     * @brief Devuelve el último nodo para recorrer la lista hacia atrás
+     * @return Puntero al último nodo (nullptr si está vacía)
+     */
+    const NodoCarga* ultimo() const { return tail; }
+
+    /**
+     * @brief Mueve al final de esta lista todos los nodos de otra
+     * @param otra Lista a vaciar; queda vacía y reutilizable
+     * @post El orden se conserva: primero los nodos propios, luego los de otra
+     * @details Si ambas listas usan el mismo modo de almacenamiento el empalme
+     * es O(1) en nodos (también se traspasan los bloques de la arena); si
+     * difieren, o si alguna está en modo flujo o anillo, los caracteres se
+     * copian uno por uno.
+     */
+    void concatenar(ListaDeCarga& otra) {
+        if (&otra == this || !otra.head) return;
+        if (buscador && otra.buscador != buscador) {
+            // Los fragmentos de otra no pasaron por este buscador
+            long pos = longitud;
+            for (const NodoCarga* cur = otra.head; cur; cur = cur->next)
+                buscador->alimentar(cur->dato, pos++);
+        }
+        if (otra.usarArena != usarArena || flujo || anillo || otra.anillo) {
+            for (NodoCarga* cur = otra.head; cur; cur = cur->next)
+                agregar(cur->dato);
+            return;
+        }
+        if (!tail) {
+            head = otra.head;
+        } else {
+            tail->next = otra.head;
+            otra.head->prev = tail;
+        }
+        tail = otra.tail;
+        longitud += otra.longitud;
+        retenidos += otra.retenidos;
+
+        if (otra.bloques) {
+            if (!bloques) {
+                bloques = otra.bloques;
+                usadosBloque = otra.usadosBloque;
+            } else {
+                // El bloque actual sigue al frente; los de otra solo se liberan al final
+                BloqueCarga* ultimoBloque = otra.bloques;
+                while (ultimoBloque->sig) ultimoBloque = ultimoBloque->sig;
+                ultimoBloque->sig = bloques->sig;
+                bloques->sig = otra.bloques;
+            }
+        }
+        otra.head = otra.tail = nullptr;
+        otra.longitud = otra.retenidos = 0;
+        otra.bloques = nullptr;
+        otra.usadosBloque = 0;
+        if (publicar) publicarCola();
+    }
+
+    /**
+     * @brief Configura cómo se reporta el progreso tras cada LOAD
+     * @param modoIncremental true para imprimir solo el fragmento agregado
+     * @param periodo Cada cuántos fragmentos imprimir el mensaje completo (0 = nunca)
+     * @details En modo incremental el costo por trama es constante; el modo
+     * completo conserva la salida original de imprimirMensaje().
+     */
+    void configurarSalida(bool modoIncremental, long periodo) {
+        incremental = modoIncremental;
+        cadaK = (periodo > 0 ? periodo : 0);
+    }
+
+    /**
+     * @brief Fija el nivel de detalle de la salida por trama
+     * @param v Nivel de verbosidad; por debajo de VERB_TRAZA no se imprime progreso
+     */
+    void fijarVerbosidad(Verbosidad v) { nivel = v; }
+
+    /**
+     * @brief Devuelve el nivel de detalle configurado
+     * @return Nivel de verbosidad
+     */
+    Verbosidad getVerbosidad() const { return nivel; }
+
+    /**
+     * @brief Solicita que el próximo progreso incluya el mensaje completo
+     * @details Solo tiene efecto en modo incremental; en modo flujo vacía
+     * además el buffer en el destino
+     */
+    void solicitarInstantanea() {
+        instantaneaPendiente = true;
+        vaciarFlujo();
+    }
+
+    /**
+     * @brief Imprime el último fragmento agregado
+     * @details Formato: +[A] (4)
+     */
+    void imprimirUltimo() {
+        if (!tail) return;
+        std::cout << "Mensaje: +[" << tail->dato << "] (" << longitud << ")" << '\n';
+    }
+
+    /**
+     * @brief Reporta el progreso después de insertar un fragmento
+     * @details En modo completo equivale a imprimirMensaje(). En modo
+     * incremental imprime solo el fragmento nuevo y, cada cadaK fragmentos
+     * o bajo demanda, una instantánea completa.
+     */
+    void imprimirProgreso() {
+        if (nivel < VERB_TRAZA) return;
+        if (!incremental) {
+            imprimirMensaje();
+            return;
+        }
+        imprimirUltimo();
+        if (instantaneaPendiente || (cadaK > 0 && longitud % cadaK == 0)) {
+            instantaneaPendiente = false;
+            imprimirMensaje();
+        }
+    }
+
+    /**
+     * @brief Imprime el mensaje actual entre corchetes
+     * @details Formato: [H][O][L][A]. En modo flujo o anillo muestra solo la
+     * ventana, precedida de "..." si ya se descartaron fragmentos.
+     */
+    void imprimirMensaje() {
+        std::cout << "Mensaje: ";
+        if (retenidos < longitud) std::cout << "...";
+        // Se arma por bloques: un write() por bloque en lugar de tres << por nodo
+        char bloque[4096];
+        size_t n = 0;
+        for (NodoCarga* cur = head; cur; cur = cur->next) {
+            if (n + 3 > sizeof(bloque)) {
+                std::cout.write(bloque, (std::streamsize)n);
+                n = 0;
+            }
+            bloque[n++] = '[';
+            bloque[n++] = cur->dato;
+            bloque[n++] = ']';
+        }
+        std::cout.write(bloque, (std::streamsize)n);
+        std::cout << '\n';
+    }
+
+    /**
+     * @brief Imprime el mensaje final completo sin corchetes
+     * @details Se llama al finalizar el procesamiento de todas las tramas.
+     * En modo flujo vacía el buffer y, si el destino es stdout, solo termina
+     * la línea del mensaje; si es otro archivo, indica cuántos fragmentos se
+     * escribieron. El llamador cierra el destino después. En modo anillo,
+     * si se descartaron fragmentos, el encabezado indica cuántos se muestran.
+     */
+    void imprimirMensajeFinal() {
+        if (flujo) {
+            vaciarFlujo();
+            if (destino == stdout) std::cout << std::endl;
+            else std::cout << "MENSAJE OCULTO ENSAMBLADO: " << longitud
+                           << " fragmentos escritos en el archivo del mensaje" << std::endl;
+            return;
+        }
+        if (retenidos < longitud)
+            std::cout << "MENSAJE OCULTO ENSAMBLADO (últimos " << retenidos << " de "
+                      << longitud << " fragmentos):" << std::endl;
+        else
+            std::cout << "MENSAJE OCULTO ENSAMBLADO:" << std::endl;
+        char bloque[4096];
+        size_t n = 0;
+        for (NodoCarga* cur = head; cur; cur = cur->next) {
+            if (n == sizeof(bloque)) {
+                std::cout.write(bloque, (std::streamsize)n);
+                n = 0;
+            }
+            bloque[n++] = cur->dato;
+        }
+        std::cout.write(bloque, (std::streamsize)n);
+        std::cout << std::endl;
+    }
+};
+
+/**************************************************************************
+ * @class RotorDeMapeo
+ * @brief Lista circular doblemente enlazada que implementa un rotor de cifrado
+ * 
+ * @details
+ * Simula un disco de cifrado similar a una rueda de César. Contiene el
+ * alfabeto A-Z en una lista circular que puede rotarse para cambiar el mapeo.
+ * La posición actual del rotor determina cómo se decodifica cada carácter.
+ **************************************************************************/
+class RotorDeMapeo {
+private:
+    NodoRotor* head;     ///< Puntero a la posición 'cero' actual del rotor
+    int size;            ///< Tamaño del rotor (26 letras)
+    Verbosidad nivel;    ///< Nivel de detalle de rotar()/imprimirEstado()
+
+public:
+    /**
+     * @brief Constructor - inicializa el rotor con A-Z
+     * @post Rotor circular creado con 26 nodos, head apuntando a 'A'
+     */
+    RotorDeMapeo() : head(nullptr), size(0), nivel(VERB_TRAZA) {
+        // Construir lista circular A..Z
+        NodoRotor* first = nullptr;
+        NodoRotor* prev = nullptr;
+        for (char ch = 'A'; ch <= 'Z'; ++ch) {
+            NodoRotor* n = new NodoRotor(ch);
+            if (!first) first = n;
+            if (prev) {
+                prev->next = n;
+                n->prev = prev;
+            }
+            prev = n;
+            ++size;
+        }
+        // Cerrar la circularidad
+        if (first && prev) {
+            first->prev = prev;
+            prev->next = first;
+            head = first;
+        }
+    }
+
+    /**
+     * @brief Destructor - libera memoria del rotor
+     * @details Rompe la circularidad antes de eliminar para evitar loops infinitos
+     */
+    ~RotorDeMapeo() {
+        if (!head) return;
+        // Romper circularidad
+        head->prev->next = nullptr;
+        NodoRotor* cur = head;
+        while (cur) {
+            NodoRotor* nx = cur->next;
+            delete cur;
+            cur = nx;
+        }
+    }
+
+    /**
+     * @brief Rota el rotor N posiciones
+     * @param N Número de posiciones a rotar (+ derecha, - izquierda)
+     * @post head se mueve N posiciones en la lista circular
+     * @details Maneja correctamente rotaciones positivas y negativas usando módulo
+     */
+    void rotar(int N) {
+        if (!head || size <= 1) return;
+        
+        // Calcular desplazamiento efectivo
+        int effective = N % size;
+        if (effective < 0) effective += size;
+        
+        // Mover head
+        for (int i = 0; i < effective; ++i) {
+            head = head->next;
+        }
+        
+        if (nivel >= VERB_TRAZA) {
+            std::cout << " -> ROTANDO ROTOR " << (N >= 0 ? "+" : "") << N 
+                 << " (efectivo: +" << effective << ")" << '\n';
+        }
+    }
+
+    /**
+     * @brief Obtiene el carácter mapeado según la rotación actual del rotor
+     * @param in Carácter de entrada a decodificar
+     * @return Carácter decodificado según el mapeo actual
+     * @details 
+     * - Los espacios se devuelven sin cambios
+     * - Las minúsculas se convierten a mayúsculas
+     * - El mapeo se realiza encontrando la posición relativa desde head
+     */
+    char getMapeo(char in) {
+        if (in == ' ') return ' ';
+        
+        // Normalizar a mayúscula
+        if (in >= 'a' && in <= 'z') 
+            in = char(in - 'a' + 'A');
+        
+        if (in < 'A' || in > 'Z') 
+            return in;
+        
+        // Encontrar posición y devolver carácter mapeado
+        int index = in - 'A';
+        NodoRotor* cur = head;
+        for (int i = 0; i < index; ++i) {
+            cur = cur->next;
+        }
+        return cur->c;
+    }
+
+    /**
+     * @brief Imprime el estado actual del rotor para debug
+     * @details Muestra las 26 letras desde la posición head
+     */
+    void imprimirEstado() {
+        if (!head || nivel < VERB_TRAZA) return;
+        std::cout << "Estado rotor (desde head): ";
+        NodoRotor* cur = head;
+        for (int i = 0; i < size; ++i) {
+            std::cout << cur->c;
+            cur = cur->next;
+        }
+        std::cout << '\n';
+    }
+
+    /**
+     * @brief Devuelve el número de posiciones del rotor
+     * @return Tamaño del alfabeto (26)
+     */
+    int getTamano() const { return size; }
+
+    /**
+     * @brief Devuelve la posición 'cero' actual del rotor
+     * @return Desplazamiento de head respecto de 'A' (0..size-1)
+     */
+    int getOffset() const { return head ? head->c - 'A' : 0; }
+
+    /**
+     * @brief Coloca el rotor en una posición absoluta sin imprimir
+     * @param o Desplazamiento respecto de 'A' (se reduce módulo size)
+     */
+    void fijarOffset(int o) {
+        if (!head || size <= 1) return;
+        int pasos = (o - getOffset()) % size;
+        if (pasos < 0) pasos += size;
+        for (int i = 0; i < pasos; ++i) head = head->next;
+    }
+
+    /**
+     * @brief Fija el nivel de detalle de rotar() e imprimirEstado()
+     * @param v Nivel de verbosidad
+     */
+    void fijarVerbosidad(Verbosidad v) { nivel = v; }
+
+    /**
+     * @brief Devuelve el nivel de detalle configurado
+     * @return Nivel de verbosidad
+     */
+    Verbosidad getVerbosidad() const { return nivel; }
+};
+
+/**************************************************************************
+ * Alfabetos del rotor por tabla
+ *
+ * Cada alfabeto describe en tiempo de compilación cuántos símbolos tiene,
+ * qué símbolo ocupa cada posición y en qué posición cae cada byte de
+ * entrada (-1 = el byte pasa sin cambios). RotorAlfabeto genera sus tablas
+ * a partir de estas funciones constexpr.
+ **************************************************************************/
+
+/**
+ * @struct AlfabetoLatino
+ * @brief A-Z; las minúsculas se decodifican como su mayúscula (protocolo original)
+ */
+struct AlfabetoLatino {
+    static constexpr int TAMANO = 26;  ///< Número de símbolos
+
+    /**
+     * @brief Símbolo de una posición
+     * @param i Posición (0..TAMANO-1)
+     * @return 'A' + i
+     */
+    static constexpr char simbolo(int i) { return char('A' + i); }
+
+    /**
+     * @brief Posición de un byte de entrada
+     * @param b Byte (0..255)
+     * @return Posición en el alfabeto, o -1 si el byte no se decodifica
+     */
+    static constexpr int posicion(int b) {
+        return (b >= 'A' && b <= 'Z') ? b - 'A'
+             : (b >= 'a' && b <= 'z') ? b - 'a' : -1;
+    }
+};
+
+/**
+ * @struct AlfabetoAlfanumerico
+ * @brief A-Z seguido de 0-9 (firmware con alfabeto extendido)
+ */
+struct AlfabetoAlfanumerico {
+    static constexpr int TAMANO = 36;  ///< Número de símbolos
+
+    /**
+     * @brief Símbolo de una posición
+     * @param i Posición (0..TAMANO-1)
+     * @return 'A'..'Z' para 0..25, '0'..'9' para 26..35
+     */
+    static constexpr char simbolo(int i) { return i < 26 ? char('A' + i) : char('0' + i - 26); }
+
+    /**
+     * @brief Posición de un byte de entrada
+     * @param b Byte (0..255)
+     * @return Posición en el alfabeto, o -1 si el byte no se decodifica
+     */
+    static constexpr int posicion(int b) {
+        return (b >= '0' && b <= '9') ? 26 + b - '0' : AlfabetoLatino::posicion(b);
+    }
+};
+
+/**
+ * @struct AlfabetoImprimible
+ * @brief ASCII imprimible completo, de ' ' a '~' (distingue mayúsculas)
+ */
+struct AlfabetoImprimible {
+    static constexpr int TAMANO = 95;  ///< Número de símbolos
+
+    /**
+     * @brief Símbolo de una posición
+     * @param i Posición (0..TAMANO-1)
+     * @return ' ' + i
+     */
+    static constexpr char simbolo(int i) { return char(' ' + i); }
+
+    /**
+     * @brief Posición de un byte de entrada
+     * @param b Byte (0..255)
+     * @return Posición en el alfabeto, o -1 si el byte no se decodifica
+     */
+    static constexpr int posicion(int b) { return (b >= ' ' && b <= '~') ? b - ' ' : -1; }
+};
+
+/**
+ * @struct IndicesTabla
+ * @brief Lista de enteros 0..N-1 como paquete de parámetros (C++11)
+ */
+template <int... I>
+struct IndicesTabla {};
+
+/**
+ * @struct GenerarIndices
+ * @brief Construye IndicesTabla<0, 1, ..., N-1> en tiempo de compilación
+ */
+template <int N, int... I>
+struct GenerarIndices : GenerarIndices<N - 1, N - 1, I...> {};
+
+template <int... I>
+struct GenerarIndices<0, I...> {
+    typedef IndicesTabla<I...> tipo;   ///< Resultado
+};
+
+/**
+ * @struct TablasAlfabeto
+ * @brief Tablas constexpr de un alfabeto, compartidas por todos sus rotores
+ * @tparam Alfabeto Descripción del alfabeto
+ * @details simbolos repite el alfabeto dos veces para que getMapeo() no
+ * necesite módulo; indice traduce cualquier byte a su posición o a -1.
+ */
+template <class Alfabeto, class Bytes = typename GenerarIndices<256>::tipo,
+          class Posiciones = typename GenerarIndices<2 * Alfabeto::TAMANO>::tipo>
+struct TablasAlfabeto;
+
+template <class Alfabeto, int... B, int... P>
+struct TablasAlfabeto<Alfabeto, IndicesTabla<B...>, IndicesTabla<P...> > {
+    static constexpr signed char indice[256] = { (signed char)Alfabeto::posicion(B)... };
+    static constexpr char simbolos[2 * Alfabeto::TAMANO] = { Alfabeto::simbolo(P % Alfabeto::TAMANO)... };
+};
+
+template <class Alfabeto, int... B, int... P>
+constexpr signed char TablasAlfabeto<Alfabeto, IndicesTabla<B...>, IndicesTabla<P...> >::indice[256];
+
+template <class Alfabeto, int... B, int... P>
+constexpr char TablasAlfabeto<Alfabeto, IndicesTabla<B...>, IndicesTabla<P...> >::simbolos[2 * Alfabeto::TAMANO];
+
+/**************************************************************************
+ * @class RotorAlfabeto
+ * @brief Rotor de mapeo por tabla con desplazamiento entero
+ * @tparam Alfabeto AlfabetoLatino, AlfabetoAlfanumerico, AlfabetoImprimible...
+ * 
+ * @details
+ * Misma interfaz que RotorDeMapeo, pero en lugar de mover un puntero por
+ * una lista circular mantiene un desplazamiento entero y consulta dos
+ * tablas generadas en compilación (TablasAlfabeto): el alfabeto duplicado
+ * y un índice de 256 entradas que traduce cualquier byte a su posición en
+ * el alfabeto (o -1 si pasa sin cambios). El tamaño es una constante, así
+ * que el módulo de rotar() lo resuelve el compilador; rotar() y getMapeo()
+ * son O(1) y cada rotor solo guarda su desplazamiento.
+ **************************************************************************/
+template <class Alfabeto>
+class RotorAlfabeto {
+private:
+    static constexpr int TAMANO = Alfabeto::TAMANO;   ///< Tamaño del alfabeto
+    typedef TablasAlfabeto<Alfabeto> Tablas;           ///< Tablas constexpr
+    int offset;                        ///< Posición 'cero' actual (0..TAMANO-1)
+    Verbosidad nivel;                  ///< Nivel de detalle de rotar()/imprimirEstado()
+
+    static_assert(TAMANO > 0 && TAMANO <= 127, "el índice por byte usa signed char");
+
+public:
+    /**
+     * @brief Constructor
+     * @post offset en 0 (cada símbolo se mapea a sí mismo)
+     */
+    RotorAlfabeto() : offset(0), nivel(VERB_TRAZA) {}
+
+    /**
+     * @brief Rota el rotor N posiciones
+     * @param N Número de posiciones a rotar (+ derecha, - izquierda)
+     * @post offset avanza N posiciones módulo TAMANO
+     */
+    void rotar(int N) {
+        int effective = N % TAMANO;
+        if (effective < 0) effective += TAMANO;
+
+        offset += effective;
+        if (offset >= TAMANO) offset -= TAMANO;
+
+        if (nivel >= VERB_TRAZA) {
+            std::cout << " -> ROTANDO ROTOR " << (N >= 0 ? "+" : "") << N 
+                 << " (efectivo: +" << effective << ")" << '\n';
+        }
+    }
+
+    /**
+     * @brief Obtiene el carácter mapeado según la rotación actual
+     * @param in Carácter de entrada a decodificar
+     * @return Carácter decodificado (con AlfabetoLatino, mismas reglas que
+     * RotorDeMapeo::getMapeo)
+     */
+    char getMapeo(char in) const {
+        int i = Tablas::indice[(unsigned char)in];
+        if (i < 0) return in;
+        return Tablas::simbolos[offset + i];
+    }
+
+    /**
+     * @brief Traduce un buffer completo con la rotación actual
+     * @param in Fragmentos de entrada
+     * @param out Destino (puede coincidir con in)
+     * @param n Número de bytes
+     * @post out[i] == getMapeo(in[i]) para todo i
+     */
+    void traducir(const char* in, char* out, size_t n) const {
+        const char* sim = Tablas::simbolos + offset;
+        for (size_t k = 0; k < n; ++k) {
+            int i = Tablas::indice[(unsigned char)in[k]];
+            out[k] = i < 0 ? in[k] : sim[i];
+        }
+    }
+
+    /**
+     * @brief Imprime el estado actual del rotor para debug
+     * @details Muestra los TAMANO símbolos desde la posición 'cero'
+     */
+    void imprimirEstado() const {
+        if (nivel < VERB_TRAZA) return;
+        std::cout << "Estado rotor (desde head): ";
+        std::cout.write(Tablas::simbolos + offset, TAMANO);
+        std::cout << '\n';
+    }
+
+    /**
+     * @brief Devuelve el número de posiciones del rotor
+     * @return Tamaño del alfabeto
+     */
+    int getTamano() const { return TAMANO; }
+
+    /**
+     * @brief Devuelve la posición 'cero' actual del rotor
+     * @return Desplazamiento respecto del primer símbolo (0..TAMANO-1)
+     */
+    int getOffset() const { return offset; }
+
+    /**
+     * @brief Coloca el rotor en una posición absoluta sin imprimir
+     * @param o Desplazamiento respecto del primer símbolo (se reduce módulo TAMANO)
+     */
+    void fijarOffset(int o) {
+        o %= TAMANO;
+        if (o < 0) o += TAMANO;
+        offset = o;
+    }
+
+    /**
+     * @brief Fija el nivel de detalle de rotar() e imprimirEstado()
+     * @param v Nivel de verbosidad
+     */
+    void fijarVerbosidad(Verbosidad v) { nivel = v; }
+
+    /**
+     * @brief Devuelve el nivel de detalle configurado
+     * @return Nivel de verbosidad
+     */
+    Verbosidad getVerbosidad() const { return nivel; }
+};
+
+template <class Alfabeto>
+constexpr int RotorAlfabeto<Alfabeto>::TAMANO;
+
+#endif // PRT7_ESTRUCTURAS_H
@@ -0,0 +1,216 @@
+/**
+ * @file indice.h
+ * @brief Índice de acceso aleatorio sobre capturas de texto (--build-index, --from/--to)
+ *
+ * @details
+ * La posición del rotor en una trama depende de todas las MAP anteriores,
+ * así que decodificar un tramo de una captura grande obliga a recorrerla
+ * desde el principio. El índice guarda cada K tramas el estado necesario
+ * para empezar ahí: posición en bytes de la línea, número de trama,
+ * rotación acumulada y longitud del mensaje hasta ese punto. Con él, un
+ * tramo se decodifica saltando a la entrada anterior más cercana y
+ * recorriendo a lo sumo K - 1 tramas sin decodificarlas.
+ *
+ * Formato del archivo (enteros de 64 bits little-endian):
+ * @code
+ * "PRT7IDX1" K tamañoCaptura tamañoRotor entradas
+ * { bytes trama longitud rotación } x entradas
+ * @endcode
+ */
+
+#ifndef PRT7_INDICE_H
+#define PRT7_INDICE_H
+
+#include <cstdio>
+#include <cstring>
+
+#include "tramas.h"
+
+/**
+ * @struct EntradaIndice
+ * @brief Estado de la captura justo antes de una trama
+ */
+struct EntradaIndice {
+    long long bytes;         ///< Posición del primer byte de la línea de la trama
+    long long trama;         ///< Número de trama (0 = primera línea)
+    long long longitud;      ///< Fragmentos decodificados antes de esta trama
+    long long rotacion;      ///< Posición del rotor partiendo de 0 (0..tamaño-1)
+
+    /**
+     * @brief Constructor - inicio de la captura
+     */
+    EntradaIndice() : bytes(0), trama(0), longitud(0), rotacion(0) {}
+};
+
+/**
+ * @brief Escribe un entero de 64 bits en little-endian
+ * @param v Valor
+ * @param f Archivo de salida
+ */
+inline void escribirEntero64(long long v, FILE* f) {
+    unsigned char b[8];
+    unsigned long long u = (unsigned long long)v;
+    for (int i = 0; i < 8; ++i) b[i] = (unsigned char)(u >> (8 * i));
+    fwrite(b, 1, 8, f);
+}
+
+/**
+ * @brief Lee un entero de 64 bits en little-endian
+ * @param f Archivo de entrada
+ * @param v Recibe el valor
+ * @return false si el archivo se terminó antes
+ */
+inline bool leerEntero64(FILE* f, long long& v) {
+    unsigned char b[8];
+    if (fread(b, 1, 8, f) != 8) return false;
+    unsigned long long u = 0;
+    for (int i = 7; i >= 0; --i) u = (u << 8) | b[i];
+    v = (long long)u;
+    return true;
+}
+
+/**************************************************************************
+ * @class IndiceCaptura
+ * @brief Construye y consulta el índice de una captura de texto
+ *
+ * @details
+ * Las tramas se numeran como las cuenta el decodificador: una por línea,
+ * incluidas las vacías o inválidas, con el mismo corte de líneas que
+ * SerialReader::leerVista(). Las entradas están en posiciones fijas del
+ * archivo, así que buscar() lee solo la que necesita.
+ **************************************************************************/
+class IndiceCaptura {
+private:
+    static const long long CABECERA = 8 + 4 * 8;   ///< Bytes antes de la primera entrada
+    static const long long REGISTRO = 4 * 8;       ///< Bytes por entrada
+
+    FILE* f;                 ///< Índice abierto para consulta (nullptr = ninguno)
+    long long cada;          ///< K: tramas entre entradas
+    long long entradas;      ///< Entradas en el archivo
+
+public:
+    /**
+     * @brief Constructor - sin índice abierto
+     */
+    IndiceCaptura() : f(nullptr), cada(0), entradas(0) {}
+
+    /**
+     * @brief Destructor - cierra el índice
+     */
+    ~IndiceCaptura() {
+        if (f) fclose(f);
+    }
+
+    /**
+     * @brief Recorre una captura y escribe su índice
+     * @param datos Captura completa en memoria (p. ej. proyectada con mmap)
+     * @param tam Bytes de la captura
+     * @param k Tramas entre entradas (al menos 1)
+     * @param tamRotor Tamaño del alfabeto del rotor (RotorActivo::getTamano())
+     * @param ruta Archivo de índice a crear
+     * @param tramas Recibe el total de tramas de la captura
+     * @return Entradas escritas, o -1 si no se pudo escribir el archivo
+     * @details Solo analiza las líneas; no decodifica ni reserva memoria
+     * por trama.
+     */
+    static long long construir(const char* datos, size_t tam, long long k, int tamRotor,
+                               const char* ruta, long long& tramas) {
+        if (k < 1) k = 1;
+        FILE* out = fopen(ruta, "wb");
+        if (!out) return -1;
+        fwrite("PRT7IDX1", 1, 8, out);
+        escribirEntero64(k, out);
+        escribirEntero64((long long)tam, out);
+        escribirEntero64(tamRotor, out);
+        escribirEntero64(0, out);    // entradas, se completa al final
+
+        long long n = 0, escritas = 0, longitud = 0;
+        int rotacion = 0;
+        Trama t;
+        const char* p = datos;
+        const char* fin = datos + tam;
+        while (p < fin) {
+            if (n % k == 0) {
+                escribirEntero64((long long)(p - datos), out);
+                escribirEntero64(n, out);
+                escribirEntero64(longitud, out);
+                escribirEntero64(rotacion, out);
+                ++escritas;
+            }
+            const char* nl = (const char*)memchr(p, '\n', (size_t)(fin - p));
+            size_t L = nl ? (size_t)(nl - p) : (size_t)(fin - p);
+            const char* sig = p + L + (nl ? 1 : 0);
+            while (L > 0 && p[L-1] == '\r') --L;
+            if (analizarTrama(p, L, t) == TRAMA_OK) {
+                if (t.tipo == TRAMA_LOAD) {
+                    ++longitud;
+                } else {
+                    int d = t.desplazamiento % tamRotor;
+                    if (d < 0) d += tamRotor;
+                    rotacion += d;
+                    if (rotacion >= tamRotor) rotacion -= tamRotor;
+                }
+            }
+            ++n;
+            p = sig;
+        }
+        tramas = n;
+        fseek(out, 8 + 3 * 8, SEEK_SET);
+        escribirEntero64(escritas, out);
+        return fclose(out) == 0 ? escritas : -1;
+    }
+
+    /**
+     * @brief Abre un índice para consultarlo
+     * @param ruta Archivo de índice
+     * @param tamCaptura Bytes de la captura actual (detecta índices obsoletos)
+     * @param tamRotor Tamaño del rotor actual
+     * @return false si no existe, está dañado o corresponde a otra captura
+     */
+    bool abrir(const char* ruta, size_t tamCaptura, int tamRotor) {
+        if (f) fclose(f);
+        f = fopen(ruta, "rb");
+        if (!f) return false;
+        char magia[8];
+        long long tam = 0, rotor = 0;
+        bool ok = fread(magia, 1, 8, f) == 8 && memcmp(magia, "PRT7IDX1", 8) == 0
+               && leerEntero64(f, cada) && leerEntero64(f, tam)
+               && leerEntero64(f, rotor) && leerEntero64(f, entradas)
+               && cada >= 1 && entradas >= 1
+               && tam == (long long)tamCaptura && rotor == tamRotor;
+        if (!ok) {
+            fclose(f);
+            f = nullptr;
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Busca la última entrada que no pasa de una trama
+     * @param trama Número de trama buscado
+     * @param e Recibe la entrada (el inicio de la captura si no hay índice)
+     * @return false si no hay índice abierto o la lectura falló
+     * @details O(1): la entrada trama / K se lee directamente de su posición
+     */
+    bool buscar(long long trama, EntradaIndice& e) const {
+        e = EntradaIndice();
+        if (!f || trama <= 0) return f != nullptr;
+        long long i = trama / cada;
+        if (i >= entradas) i = entradas - 1;
+        if (fseek(f, (long)(CABECERA + i * REGISTRO), SEEK_SET) != 0) return false;
+        EntradaIndice r;
+        if (!leerEntero64(f, r.bytes) || !leerEntero64(f, r.trama)
+            || !leerEntero64(f, r.longitud) || !leerEntero64(f, r.rotacion))
+            return false;
+        e = r;
+        return true;
+    }
+
+    /**
+     * @brief Tramas entre entradas del índice abierto
+     * @return K
+     */
+    long long getCada() const { return cada; }
+};
+
+#endif // PRT7_INDICE_H
@@ -0,0 +1,303 @@
+/**
+ * @file latencia.h
+ * @brief Latencia por trama desde la llegada de los bytes hasta la salida (--latency)
+ *
+ * @details
+ * Cada línea del protocolo de texto se marca en cuatro puntos: cuando el
+ * read() que trajo su '\n' volvió (SerialReader::getLlegadaNs()), tras el
+ * parseo, tras Decodificador::procesar() y cuando su salida deja el proceso
+ * con el siguiente vaciado de std::cout. Las diferencias entre puntos
+ * consecutivos, y el total, van a histogramas de precisión fija (estilo
+ * HDR) de los que se informan p50, p99 y p999.
+ *
+ * La salida se vacía cuando la próxima lectura puede bloquearse (no queda
+ * ninguna línea completa recibida) o cuando hay PENDIENTES tramas sin
+ * vaciar; en una captura proyectada en memoria solo ocurre lo segundo, así
+ * que --latency cambia el tamaño de las escrituras de la traza.
+ *
+ * Opcionalmente, las tramas cuya latencia total supera un umbral se
+ * exportan como eventos "X" de Chrome trace (chrome://tracing, Perfetto).
+ */
+
+#ifndef PRT7_LATENCIA_H
+#define PRT7_LATENCIA_H
+
+#include <cstdio>
+#include <iostream>
+
+#include "estructuras.h"
+#include "tramas.h"
+
+/**************************************************************************
+ * @struct HistogramaHdr
+ * @brief Histograma con SUBCUBETAS cubetas lineales por potencia de dos
+ *
+ * @details
+ * Los valores menores que SUBCUBETAS tienen cubeta propia; a partir de ahí
+ * cada intervalo [2^e, 2^(e+1)) se parte en SUBCUBETAS cubetas iguales, de
+ * modo que el error relativo de un percentil es menor que 1/SUBCUBETAS en
+ * todo el rango (a diferencia de HistogramaLog2, que solo da la potencia).
+ **************************************************************************/
+struct HistogramaHdr {
+    static const int BITS_SUB = 4;                       ///< log2 de SUBCUBETAS
+    static const int SUBCUBETAS = 1 << BITS_SUB;         ///< Cubetas por potencia de dos
+    static const int MAX_EXPONENTE = 40;                 ///< Cubre valores hasta 2^41 (unos 36 minutos en ns)
+    static const int CUBETAS = SUBCUBETAS * (MAX_EXPONENTE - BITS_SUB + 2);  ///< Total de cubetas
+    long cuenta[CUBETAS];            ///< Muestras por cubeta
+    long n;                          ///< Total de muestras
+    long long maximo;                ///< Mayor muestra
+
+    /**
+     * @brief Constructor - histograma vacío
+     */
+    HistogramaHdr() : n(0), maximo(0) {
+        for (int i = 0; i < CUBETAS; ++i) cuenta[i] = 0;
+    }
+
+    /**
+     * @brief Cubeta de un valor
+     * @param v Valor no negativo
+     * @return Índice en cuenta
+     */
+    static int indice(long long v) {
+        if (v < SUBCUBETAS) return (int)v;
+        int e = BITS_SUB;
+        for (unsigned long long x = (unsigned long long)v >> (BITS_SUB + 1); x; x >>= 1) ++e;
+        if (e > MAX_EXPONENTE) return CUBETAS - 1;
+        int sub = (int)((unsigned long long)v >> (e - BITS_SUB)) - SUBCUBETAS;
+        return SUBCUBETAS + (e - BITS_SUB) * SUBCUBETAS + sub;
+    }
+
+    /**
+     * @brief Mayor valor que cae en una cubeta
+     * @param i Índice de cubeta
+     * @return Cota superior (inclusive) de la cubeta
+     */
+    static long long limite(int i) {
+        if (i < SUBCUBETAS) return i;
+        int e = (i - SUBCUBETAS) / SUBCUBETAS + BITS_SUB;
+        int sub = (i - SUBCUBETAS) % SUBCUBETAS;
+        return ((long long)(SUBCUBETAS + sub + 1) << (e - BITS_SUB)) - 1;
+    }
+
+    /**
+     * @brief Registra una muestra
+     * @param v Valor (negativos cuentan como 0)
+     */
+    void registrar(long long v) {
+        if (v < 0) v = 0;
+        ++cuenta[indice(v)];
+        ++n;
+        if (v > maximo) maximo = v;
+    }
+
+    /**
+     * @brief Aproxima un percentil con la cota superior de su cubeta
+     * @param p Fracción (0..1)
+     * @return Cota superior del percentil (nunca mayor que el máximo)
+     */
+    long long percentil(double p) const {
+        long objetivo = (long)(p * (double)n);
+        long acumulado = 0;
+        for (int i = 0; i < CUBETAS; ++i) {
+            acumulado += cuenta[i];
+            if (acumulado > objetivo) return limite(i) < maximo ? limite(i) : maximo;
+        }
+        return maximo;
+    }
+};
+
+/**
+ * @struct MuestraLatencia
+ * @brief Marcas de tiempo de una trama (relojNs())
+ */
+struct MuestraLatencia {
+    long long trama;         ///< Número de trama (0 = primera línea leída)
+    long long llegada;       ///< Vuelta del read() que trajo la línea
+    long long parseo;        ///< Fin del parseo
+    long long proceso;       ///< Fin de Decodificador::procesar()
+    long long salida;        ///< Vaciado de std::cout que incluyó su traza
+    TipoTrama tipo;          ///< LOAD o MAP
+};
+
+/**************************************************************************
+ * @class LatenciaTramas
+ * @brief Histogramas de latencia por etapa y exportación de tramas lentas
+ *
+ * @details
+ * Las tramas procesadas esperan en un arreglo de PENDIENTES entradas hasta
+ * el siguiente vaciarSalida(), que les asigna la hora del vaciado. Las
+ * tramas inválidas solo cuentan en la primera etapa. Se guardan a lo sumo
+ * MAX_LENTAS tramas lentas; las siguientes solo se cuentan.
+ **************************************************************************/
+class LatenciaTramas {
+public:
+    static const int PENDIENTES = 4096;    ///< Tramas procesadas entre vaciados, como máximo
+    static const int MAX_LENTAS = 10000;   ///< Tramas lentas retenidas para la traza
+
+private:
+    long long inicioNs;              ///< Origen de las marcas de la traza
+    long long umbralNs;              ///< Latencia total a partir de la cual una trama es lenta
+    const char* rutaTraza;           ///< Chrome trace a escribir (nullptr = ninguno)
+    long long tramas;                ///< Líneas vistas
+    long long llegadaActual;         ///< Llegada de la línea en curso
+    MuestraLatencia* pendientes;     ///< Tramas procesadas sin vaciar
+    int enPendientes;                ///< Entradas válidas en pendientes
+    MuestraLatencia* lentas;         ///< Tramas lentas (solo con rutaTraza)
+    int enLentas;                    ///< Entradas válidas en lentas
+    long long totalLentas;           ///< Tramas lentas, retenidas o no
+    long vaciados;                   ///< Llamadas a vaciarSalida() con tramas pendientes
+    HistogramaHdr espera;            ///< llegada -> parseo (incluye la espera en el buffer)
+    HistogramaHdr proceso;           ///< parseo -> procesar
+    HistogramaHdr salida;            ///< procesar -> vaciado de la salida
+    HistogramaHdr total;             ///< llegada -> vaciado de la salida
+
+    /**
+     * @brief Escribe una línea del resumen
+     * @param f Destino
+     * @param nombre Etapa
+     * @param h Histograma de la etapa
+     */
+    static void imprimirEtapa(FILE* f, const char* nombre, const HistogramaHdr& h) {
+        fprintf(f, "  %-18s %8ld %11.1f %11.1f %11.1f %11.1f\n", nombre, h.n,
+                (double)h.percentil(0.5) / 1e3, (double)h.percentil(0.99) / 1e3,
+                (double)h.percentil(0.999) / 1e3, (double)h.maximo / 1e3);
+    }
+
+    /**
+     * @brief Escribe un evento "X" (duración completa) de Chrome trace
+     * @param f Destino
+     * @param primero false si ya se escribió otro evento antes
+     * @param nombre Nombre del evento
+     * @param m Trama del evento
+     * @param desde Inicio (relojNs())
+     * @param hasta Fin (relojNs())
+     */
+    void escribirEvento(FILE* f, bool primero, const char* nombre, const MuestraLatencia& m,
+                        long long desde, long long hasta) const {
+        fprintf(f, "%s\n{\"name\": \"%s\", \"cat\": \"prt7\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                   "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"trama\": %lld, \"tipo\": \"%s\"}}",
+                primero ? "" : ",", nombre, (double)(desde - inicioNs) / 1e3,
+                (double)(hasta - desde) / 1e3, m.trama, m.tipo == TRAMA_LOAD ? "LOAD" : "MAP");
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param lentaUs Latencia total (µs) desde la que una trama va a la traza
+     * @param traza Archivo Chrome trace, o nullptr para solo los histogramas
+     */
+    LatenciaTramas(long long lentaUs, const char* traza)
+        : inicioNs(relojNs()), umbralNs(lentaUs * 1000), rutaTraza(traza), tramas(0),
+          llegadaActual(0), pendientes(new MuestraLatencia[PENDIENTES]), enPendientes(0),
+          lentas(traza ? new MuestraLatencia[MAX_LENTAS] : nullptr), enLentas(0),
+          totalLentas(0), vaciados(0) {}
+
+    /**
+     * @brief Destructor
+     */
+    ~LatenciaTramas() {
+        delete[] pendientes;
+        delete[] lentas;
+    }
+
+    /**
+     * @brief Registra la llegada de la siguiente línea
+     * @param ns SerialReader::getLlegadaNs() tras entregarla
+     */
+    void llegada(long long ns) {
+        llegadaActual = ns > 0 ? ns : relojNs();
+        ++tramas;
+    }
+
+    /**
+     * @brief La línea en curso no es una trama válida
+     * @param finParseo relojNs() al terminar el parseo
+     */
+    void invalida(long long finParseo) {
+        espera.registrar(finParseo - llegadaActual);
+    }
+
+    /**
+     * @brief La línea en curso se procesó
+     * @param tipo LOAD o MAP
+     * @param finParseo relojNs() al terminar el parseo
+     * @param finProceso relojNs() al terminar Decodificador::procesar()
+     * @post Si el arreglo de pendientes se llenó, la salida ya se vació
+     */
+    void procesada(TipoTrama tipo, long long finParseo, long long finProceso) {
+        espera.registrar(finParseo - llegadaActual);
+        proceso.registrar(finProceso - finParseo);
+        MuestraLatencia& m = pendientes[enPendientes++];
+        m.trama = tramas - 1;
+        m.llegada = llegadaActual;
+        m.parseo = finParseo;
+        m.proceso = finProceso;
+        m.tipo = tipo;
+        if (enPendientes == PENDIENTES) vaciarSalida();
+    }
+
+    /**
+     * @brief Vacía std::cout y cierra la latencia de las tramas pendientes
+     */
+    void vaciarSalida() {
+        if (enPendientes == 0) return;
+        std::cout.flush();
+        long long t = relojNs();
+        for (int i = 0; i < enPendientes; ++i) {
+            MuestraLatencia& m = pendientes[i];
+            m.salida = t;
+            salida.registrar(t - m.proceso);
+            total.registrar(t - m.llegada);
+            if (t - m.llegada < umbralNs) continue;
+            ++totalLentas;
+            if (lentas && enLentas < MAX_LENTAS) lentas[enLentas++] = m;
+        }
+        enPendientes = 0;
+        ++vaciados;
+    }
+
+    /**
+     * @brief Escribe el resumen por etapa en stderr (microsegundos)
+     */
+    void imprimirResumen() const {
+        fprintf(stderr, "latencia: %lld tramas, %ld vaciados de la salida, %lld tramas de %.1f us o más\n",
+                tramas, vaciados, totalLentas, (double)umbralNs / 1e3);
+        fprintf(stderr, "  %-18s %8s %11s %11s %11s %11s\n", "etapa (us)", "n", "p50", "p99", "p999", "max");
+        imprimirEtapa(stderr, "llegada->parseo", espera);
+        imprimirEtapa(stderr, "parseo->procesar", proceso);
+        imprimirEtapa(stderr, "procesar->salida", salida);
+        imprimirEtapa(stderr, "total", total);
+    }
+
+    /**
+     * @brief Indica si hay que escribir la traza de tramas lentas
+     * @return true si se indicó --latency-trace
+     */
+    bool tieneDestinoTraza() const { return rutaTraza != nullptr; }
+
+    /**
+     * @brief Escribe las tramas lentas como Chrome trace JSON
+     * @return Tramas escritas, o -1 si no se pudo escribir el archivo
+     * @details Cada trama es un evento con su latencia total y, anidados,
+     * uno por etapa; las marcas son µs desde el inicio de la sesión.
+     */
+    int escribirTraza() const {
+        FILE* f = fopen(rutaTraza, "w");
+        if (!f) return -1;
+        fprintf(f, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+        char nombre[48];
+        for (int i = 0; i < enLentas; ++i) {
+            const MuestraLatencia& m = lentas[i];
+            snprintf(nombre, sizeof(nombre), "trama %lld", m.trama);
+            escribirEvento(f, i == 0, nombre, m, m.llegada, m.salida);
+            escribirEvento(f, false, "llegada->parseo", m, m.llegada, m.parseo);
+            escribirEvento(f, false, "parseo->procesar", m, m.parseo, m.proceso);
+            escribirEvento(f, false, "procesar->salida", m, m.proceso, m.salida);
+        }
+        fprintf(f, "\n]}\n");
+        return fclose(f) == 0 ? enLentas : -1;
+    }
+};
+
+#endif // PRT7_LATENCIA_H
@@ -0,0 +1,154 @@
+/**
+ * @file lote.h
+ * @brief Decodificación por lotes de fragmentos LOAD
+ *
+ * @details
+ * Entre dos tramas MAP el rotor no cambia, así que una racha de LOAD es una
+ * traducción byte a byte: minúsculas a mayúsculas, A-Z desplazadas por la
+ * posición del rotor y el resto (espacio incluido) sin cambios. Este núcleo
+ * aplica esa traducción a un buffer completo de una sola vez, con SSE2,
+ * AVX2 o NEON según lo que el compilador tenga habilitado y una versión
+ * escalar para el resto de plataformas y para la cola del buffer.
+ */
+
+#ifndef PRT7_LOTE_H
+#define PRT7_LOTE_H
+
+#include <cstddef>
+
+#include "estructuras.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PRT7_LOTE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PRT7_LOTE_NEON
+#endif
+
+/**
+ * @brief Traducción escalar de un tramo de fragmentos
+ * @param in Fragmentos de entrada
+ * @param out Destino (puede coincidir con in)
+ * @param n Número de bytes
+ * @param offset Posición del rotor respecto de 'A' (0..25)
+ */
+inline void decodificarLoteEscalar(const char* in, char* out, size_t n, int offset) {
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char b = (unsigned char)in[i];
+        // (b | 0x20) cae en 'a'..'z' solo para letras de cualquier caja
+        unsigned idx = (unsigned)((b | 0x20) - 'a');
+        if (idx < 26) {
+            idx += (unsigned)offset;
+            if (idx >= 26) idx -= 26;
+            out[i] = char('A' + idx);
+        } else {
+            out[i] = (char)b;
+        }
+    }
+}
+
+/**
+ * @brief Decodifica un buffer de fragmentos LOAD con el rotor fijo
+ * @param in Fragmentos de entrada, en orden de llegada
+ * @param out Destino (puede coincidir con in)
+ * @param n Número de bytes
+ * @param offset Posición del rotor respecto de 'A' (RotorActivo::getOffset())
+ * @post out[i] == rotor.getMapeo(in[i]) para todo i
+ */
+inline void decodificarLote(const char* in, char* out, size_t n, int offset) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i k20 = _mm256_set1_epi8(0x20);
+    const __m256i ka = _mm256_set1_epi8('a');
+    const __m256i kA = _mm256_set1_epi8('A');
+    const __m256i km1 = _mm256_set1_epi8(-1);
+    const __m256i k25 = _mm256_set1_epi8(25);
+    const __m256i k26 = _mm256_set1_epi8(26);
+    const __m256i koff = _mm256_set1_epi8((char)offset);
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i x = _mm256_sub_epi8(_mm256_or_si256(v, k20), ka);
+        __m256i letra = _mm256_and_si256(_mm256_cmpgt_epi8(x, km1), _mm256_cmpgt_epi8(k26, x));
+        __m256i y = _mm256_add_epi8(x, koff);
+        y = _mm256_sub_epi8(y, _mm256_and_si256(_mm256_cmpgt_epi8(y, k25), k26));
+        y = _mm256_add_epi8(y, kA);
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_blendv_epi8(v, y, letra));
+    }
+#elif defined(PRT7_LOTE_SSE2)
+    const __m128i k20 = _mm_set1_epi8(0x20);
+    const __m128i ka = _mm_set1_epi8('a');
+    const __m128i kA = _mm_set1_epi8('A');
+    const __m128i km1 = _mm_set1_epi8(-1);
+    const __m128i k25 = _mm_set1_epi8(25);
+    const __m128i k26 = _mm_set1_epi8(26);
+    const __m128i koff = _mm_set1_epi8((char)offset);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        // x = minúscula - 'a'; es letra si 0 <= x < 26 (comparación con signo)
+        __m128i x = _mm_sub_epi8(_mm_or_si128(v, k20), ka);
+        __m128i letra = _mm_and_si128(_mm_cmpgt_epi8(x, km1), _mm_cmplt_epi8(x, k26));
+        __m128i y = _mm_add_epi8(x, koff);
+        y = _mm_sub_epi8(y, _mm_and_si128(_mm_cmpgt_epi8(y, k25), k26));
+        y = _mm_add_epi8(y, kA);
+        __m128i r = _mm_or_si128(_mm_and_si128(letra, y), _mm_andnot_si128(letra, v));
+        _mm_storeu_si128((__m128i*)(out + i), r);
+    }
+#elif defined(PRT7_LOTE_NEON)
+    const uint8x16_t k20 = vdupq_n_u8(0x20);
+    const uint8x16_t ka = vdupq_n_u8('a');
+    const uint8x16_t kA = vdupq_n_u8('A');
+    const uint8x16_t k25 = vdupq_n_u8(25);
+    const uint8x16_t k26 = vdupq_n_u8(26);
+    const uint8x16_t koff = vdupq_n_u8((uint8_t)offset);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)(in + i));
+        uint8x16_t x = vsubq_u8(vorrq_u8(v, k20), ka);
+        uint8x16_t letra = vcltq_u8(x, k26);
+        uint8x16_t y = vaddq_u8(x, koff);
+        y = vsubq_u8(y, vandq_u8(vcgtq_u8(y, k25), k26));
+        y = vaddq_u8(y, kA);
+        vst1q_u8((uint8_t*)(out + i), vbslq_u8(letra, y, v));
+    }
+#endif
+    decodificarLoteEscalar(in + i, out + i, n - i, offset);
+}
+
+/**
+ * @brief Decodifica un lote con un rotor por tabla de cualquier alfabeto
+ * @param in Fragmentos de entrada
+ * @param out Destino (puede coincidir con in)
+ * @param n Número de bytes
+ * @param rotor Rotor en su posición actual
+ * @details Alfabetos distintos de A-Z recorren las tablas del rotor
+ */
+template <class Alfabeto>
+inline void decodificarLote(const char* in, char* out, size_t n, const RotorAlfabeto<Alfabeto>& rotor) {
+    rotor.traducir(in, out, n);
+}
+
+/**
+ * @brief Decodifica un lote con el rotor por tabla A-Z (núcleo vectorial)
+ * @param in Fragmentos de entrada
+ * @param out Destino (puede coincidir con in)
+ * @param n Número de bytes
+ * @param rotor Rotor en su posición actual
+ */
+inline void decodificarLote(const char* in, char* out, size_t n, const RotorTabla& rotor) {
+    decodificarLote(in, out, n, rotor.getOffset());
+}
+
+/**
+ * @brief Decodifica un lote con el rotor de lista circular (núcleo vectorial)
+ * @param in Fragmentos de entrada
+ * @param out Destino (puede coincidir con in)
+ * @param n Número de bytes
+ * @param rotor Rotor en su posición actual
+ */
+inline void decodificarLote(const char* in, char* out, size_t n, const RotorDeMapeo& rotor) {
+    decodificarLote(in, out, n, rotor.getOffset());
+}
+
+#endif // PRT7_LOTE_H
@@ -23,6 +23,13 @@
  * @code
  * ./prtdcd --sim entrada.txt
  * ./prtdcd --serial /dev/ttyUSB0
+ * ./prtdcd --sim entrada.txt --incremental --snapshot 1000
+ * ./prtdcd --serial /dev/ttyUSB0 --verbosity quiet --stream mensaje.txt
+ * ./prtdcd --sim entrada.txt --rotors 3 --stepping odometer
+ * ./prtdcd --serial /dev/ttyUSB0 --async-output | tee traza.log
+ * ./prtdcd --serial /dev/ttyUSB0 --latency-trace lentas.json --slow-us 500
+ * ./prtdcd --serial /dev/ttyUSB0 --verbosity quiet --ring 4096 --alert SOS --alert MAYDAY
+ * ./prtdcd --sim captura.txt --replay-baud 2000000 --pipeline --verbosity quiet
  * @endcode
  */
 
@@ -30,566 +37,818 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <cctype>
-#include <cerrno>
+#include <csignal>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 #ifdef __linux__
-#include <termios.h>
-#include <unistd.h>
-#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
 #endif
 
+#include "estructuras.h"
+#include "tramas.h"
+#include "serial_reader.h"
+#include "decodificador.h"
+#include "paralelo.h"
+#include "canal.h"
+#include "multiplexor.h"
+#include "estadisticas.h"
+#include "latencia.h"
+#include "ritmo.h"
+#include "punto_control.h"
+#include "indice.h"
+#include "salida_asincrona.h"
+
 using std::cout;
 using std::endl;
 
-/**************************************************************************
- * Declaraciones adelantadas
- **************************************************************************/
-class ListaDeCarga;
-class RotorDeMapeo;
+/**
+ * @brief Instala un manejador de señal sin reiniciar llamadas al sistema
+ * @param sig Señal a atender
+ * @param manejador Función a invocar
+ * @details Sin SA_RESTART, un read() bloqueado en el serial vuelve con
+ * EINTR y el bucle puede revisar las banderas de terminación.
+ */
+static void instalarManejador(int sig, void (*manejador)(int)) {
+#ifdef __linux__
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = manejador;
+    sigemptyset(&sa.sa_mask);
+    sigaction(sig, &sa, nullptr);
+#else
+    signal(sig, manejador);
+#endif
+}
 
-/**************************************************************************
- * @class TramaBase
- * @brief Clase base abstracta para todas las tramas del protocolo PRT-7
- * 
- * @details
- * Define la interfaz común para las tramas LOAD y MAP. Utiliza polimorfismo
- * para permitir el procesamiento uniforme de diferentes tipos de tramas.
- * El destructor virtual es crítico para la correcta liberación de memoria.
- **************************************************************************/
-class TramaBase {
-public:
-    /**
-     * @brief Procesa la trama y modifica las estructuras de datos
-     * @param carga Puntero a la lista de carga donde se almacenan fragmentos decodificados
-     * @param rotor Puntero al rotor de mapeo que realiza la decodificación
-     * @pre carga y rotor deben estar inicializados
-     * @post Las estructuras pueden ser modificadas según el tipo de trama
-     */
-    virtual void procesar(ListaDeCarga* carga, RotorDeMapeo* rotor) = 0;
-    
-    /**
-     * @brief Destructor virtual para permitir polimorfismo correcto
-     * @details Esencial para evitar fugas de memoria al eliminar objetos derivados
-     */
-    virtual ~TramaBase() {}
-};
+/**
+ * @brief Cada cuánto se atienden --stats y SIGUSR1 mientras la entrada no trae datos
+ */
+static const int PERIODO_REPOSO_MS = 100;
 
-/**************************************************************************
- * Estructuras de Nodos
- **************************************************************************/
+/**
+ * @brief Bandera de instantánea bajo demanda (activada por SIGUSR2)
+ */
+static volatile sig_atomic_t g_instantanea = 0;
 
 /**
- * @struct NodoCarga
- * @brief Nodo para la lista doblemente enlazada de fragmentos decodificados
+ * @brief Manejador de señal que solicita una instantánea del mensaje
+ * @param sig Número de señal recibida
  */
-struct NodoCarga {
-    char dato;           ///< Carácter decodificado almacenado
-    NodoCarga* prev;     ///< Puntero al nodo anterior
-    NodoCarga* next;     ///< Puntero al nodo siguiente
-    
-    /**
-     * @brief Constructor del nodo
-     * @param d Carácter a almacenar
-     */
-    NodoCarga(char d) : dato(d), prev(nullptr), next(nullptr) {}
-};
+static void manejarInstantanea(int sig) {
+    (void)sig;
+    g_instantanea = 1;
+}
 
 /**
- * @struct NodoRotor
- * @brief Nodo para la lista circular del rotor de mapeo
+ * @brief Bandera de terminación ordenada (activada por SIGINT/SIGTERM)
  */
-struct NodoRotor {
-    char c;              ///< Carácter del alfabeto (A-Z)
-    NodoRotor* prev;     ///< Puntero al nodo anterior (circular)
-    NodoRotor* next;     ///< Puntero al nodo siguiente (circular)
-    
-    /**
-     * @brief Constructor del nodo
-     * @param ch Carácter del alfabeto
-     */
-    NodoRotor(char ch) : c(ch), prev(nullptr), next(nullptr) {}
-};
+static volatile sig_atomic_t g_detener = 0;
 
-/**************************************************************************
- * @class ListaDeCarga
- * @brief Lista doblemente enlazada para almacenar fragmentos decodificados
- * 
- * @details
- * Implementación manual (sin STL) de una lista doblemente enlazada que
- * mantiene el orden de los fragmentos de mensaje a medida que se decodifican.
- **************************************************************************/
-class ListaDeCarga {
-private:
-    NodoCarga* head;     ///< Puntero al primer nodo
-    NodoCarga* tail;     ///< Puntero al último nodo
+/**
+ * @brief Manejador de señal que solicita terminar la sesión
+ * @param sig Número de señal recibida
+ * @details El bucle principal termina y aún se imprime el mensaje ensamblado
+ */
+static void manejarDetener(int sig) {
+    (void)sig;
+    g_detener = 1;
+}
 
-public:
-    /**
-     * @brief Constructor por defecto
-     * @post Lista vacía inicializada
-     */
-    ListaDeCarga() : head(nullptr), tail(nullptr) {}
-    
-    /**
-     * @brief Destructor - libera toda la memoria de los nodos
-     * @details Recorre la lista y elimina cada nodo individualmente
-     */
-    ~ListaDeCarga() {
-        NodoCarga* cur = head;
-        while (cur) {
-            NodoCarga* nx = cur->next;
-            delete cur;
-            cur = nx;
-        }
+/**
+ * @brief Bandera de volcado de estadísticas (SIGUSR1)
+ */
+static volatile sig_atomic_t g_volcado = 0;
+
+/**
+ * @brief Manejador de señal que solicita el volcado JSON de estadísticas
+ * @param sig Número de señal recibida
+ * @details El volcado se hace en el bucle principal, al procesar la siguiente trama
+ */
+static void manejarVolcado(int sig) {
+    (void)sig;
+    g_volcado = 1;
+}
+
+/**
+ * @brief Imprime en la traza una trama leída en formato binario
+ * @param t Trama extraída de un bloque
+ * @details Usa la misma notación que el protocolo de texto
+ */
+static void imprimirTramaRecibida(const Trama& t) {
+    cout << "Trama recibida: [";
+    if (t.tipo == TRAMA_LOAD) {
+        if (t.fragmento == ' ') cout << "L,Space";
+        else cout << "L," << t.fragmento;
+    } else if (t.tipo == TRAMA_MAP) {
+        cout << "M," << t.desplazamiento;
+    } else {
+        cout << "?";
     }
+    cout << "] ";
+}
 
-    /**
-     * @brief Inserta un carácter al final de la lista
-     * @param dato Carácter a insertar
-     * @post El carácter se agrega al final, manteniendo el orden de llegada
-     */
-    void insertarAlFinal(char dato) {
-        NodoCarga* n = new NodoCarga(dato);
-        if (!tail) {
-            head = tail = n;
-        } else {
-            tail->next = n;
-            n->prev = tail;
-            tail = n;
-        }
+/**
+ * @brief Imprime los contadores de tramas de una sesión
+ * @param deco Decodificador ya finalizado
+ */
+static void imprimirContadores(const Decodificador& deco) {
+    cout << "Tramas: " << (deco.getLoads() + deco.getMaps() + deco.getInvalidas())
+         << " (LOAD: " << deco.getLoads() << ", MAP: " << deco.getMaps()
+         << ", inválidas: " << deco.getInvalidas()
+         << ", rotaciones aplicadas: " << deco.getRotaciones() << ")\n";
+}
+
+/**
+ * @brief Agrega al buscador las palabras de un archivo, una por línea
+ * @param b Buscador aún sin compilar
+ * @param ruta Archivo de palabras (las líneas vacías se ignoran)
+ * @return false si no se pudo abrir el archivo
+ * @details Las líneas de más de 1023 bytes se truncan.
+ */
+static bool cargarPatrones(BuscadorPatrones& b, const char* ruta) {
+    FILE* f = fopen(ruta, "r");
+    if (!f) return false;
+    char linea[1024];
+    while (fgets(linea, sizeof(linea), f)) {
+        size_t L = strlen(linea);
+        while (L > 0 && (linea[L-1] == '\n' || linea[L-1] == '\r')) --L;
+        b.agregar(linea, L);
     }
+    fclose(f);
+    return true;
+}
 
-    /**
-     * @brief Imprime el mensaje actual entre corchetes
-     * @details Formato: [H][O][L][A]
-     */
-    void imprimirMensaje() {
-        cout << "Mensaje: ";
-        NodoCarga* cur = head;
-        while (cur) {
-            cout << "[" << (cur->dato == ' ' ? ' ' : cur->dato) << "]";
-            cur = cur->next;
-        }
-        cout << endl;
+/**
+ * @brief Imprime cuántas veces apareció cada palabra vigilada
+ * @param b Buscador de la sesión
+ */
+static void imprimirAlertas(const BuscadorPatrones& b) {
+    cout << "Alertas: " << b.getTotalCoincidencias() << " coincidencias (";
+    for (int i = 0; i < b.getPatrones(); ++i)
+        cout << (i ? ", " : "") << '"' << b.getPatron(i) << "\": " << b.getCoincidencias(i);
+    cout << ")\n";
+}
+
+/**
+ * @brief Guarda un punto de control con el estado actual de la sesión
+ * @param pc Archivos del punto de control
+ * @param deco Decodificador de la sesión
+ * @param carga Lista en modo flujo sobre el .msg
+ * @param reader Fuente (da la posición tras la última trama consumida)
+ * @details Decodifica el lote pendiente y vacía el mensaje en el .msg
+ * antes de escribir el .ckpt, que así nunca va por delante del mensaje.
+ */
+static void guardarPuntoControl(PuntoControl& pc, Decodificador& deco,
+                                ListaDeCarga& carga, const SerialReader& reader) {
+    deco.vaciarLote();
+    carga.vaciarFlujo();
+    EstadoControl e;
+    e.posicionRotor = deco.getPosicionRotor();
+    e.loads = deco.getLoads();
+    e.maps = deco.getMaps();
+    e.invalidas = deco.getInvalidas();
+    e.rotaciones = deco.getRotaciones();
+    e.secuencia = (long long)e.loads + e.maps + e.invalidas;
+    e.bytes = reader.posicion();
+    e.longitud = carga.getLongitud();
+    if (!pc.guardar(e))
+        cout << "Error escribiendo '" << pc.getRutaEstado() << "': " << strerror(errno) << '\n';
+}
+
+/**
+ * @brief Lleva la lectura y el rotor al estado previo a una trama (--from)
+ * @param reader Fuente de texto recién abierta
+ * @param rotor Rotor de la sesión (en su posición inicial)
+ * @param desde Número de la primera trama a decodificar
+ * @param rutaIndice Índice de la captura (ver indice.h)
+ * @param nivel Verbosidad de los avisos
+ * @return Fragmentos del mensaje completo anteriores a la trama desde
+ * @details Con un índice válido salta a la entrada anterior más cercana;
+ * sin él recorre la captura desde el principio. Las tramas saltadas solo
+ * se analizan para acumular la rotación; no se decodifican ni se cuentan.
+ */
+static long long posicionarEnTrama(SerialReader& reader, RotorActivo& rotor, long long desde,
+                                   const char* rutaIndice, Verbosidad nivel) {
+    EntradaIndice e;
+    IndiceCaptura indice;
+    const char* datos;
+    size_t tam;
+    if (reader.datosProyectados(datos, tam) && indice.abrir(rutaIndice, tam, rotor.getTamano())
+        && indice.buscar(desde, e) && reader.reposicionar(e.bytes)) {
+        if (nivel >= VERB_RESUMEN)
+            cout << "Índice '" << rutaIndice << "': salto a la trama " << e.trama
+                 << " (byte " << e.bytes << ")." << '\n';
+    } else {
+        e = EntradaIndice();
+        if (nivel >= VERB_RESUMEN && desde > 0)
+            cout << "Sin índice válido en '" << rutaIndice
+                 << "'; se recorre la captura desde el principio." << '\n';
     }
 
-    /**
-     * @brief Imprime el mensaje final completo sin corchetes
-     * @details Se llama al finalizar el procesamiento de todas las tramas
-     */
-    void imprimirMensajeFinal() {
-        cout << "MENSAJE OCULTO ENSAMBLADO:" << endl;
-        NodoCarga* cur = head;
-        while (cur) {
-            cout << cur->dato;
-            cur = cur->next;
+    const int tamRotor = rotor.getTamano();
+    int rotacion = (int)e.rotacion;
+    long long longitud = e.longitud;
+    Trama t;
+    const char* vista;
+    size_t largo;
+    for (long long n = e.trama; n < desde && reader.leerVista(vista, largo); ++n) {
+        if (analizarTrama(vista, largo, t) != TRAMA_OK) continue;
+        if (t.tipo == TRAMA_LOAD) {
+            ++longitud;
+            continue;
         }
-        cout << endl;
+        int d = t.desplazamiento % tamRotor;
+        if (d < 0) d += tamRotor;
+        rotacion += d;
+        if (rotacion >= tamRotor) rotacion -= tamRotor;
     }
-};
+    rotor.fijarOffset(rotacion);
+    return longitud;
+}
 
 /**************************************************************************
- * @class RotorDeMapeo
- * @brief Lista circular doblemente enlazada que implementa un rotor de cifrado
- * 
+ * @struct ConsumidorTramas
+ * @brief Aplica líneas de texto o bloques binarios sobre un Decodificador
+ *
  * @details
- * Simula un disco de cifrado similar a una rueda de César. Contiene el
- * alfabeto A-Z en una lista circular que puede rotarse para cambiar el mapeo.
- * La posición actual del rotor determina cómo se decodifica cada carácter.
+ * Contiene el cuerpo del bucle principal para que lo compartan la lectura
+ * directa del SerialReader y el consumidor del pipeline (--pipeline).
+ * Como ReposoLector, vacía el lote del decodificador cuando la entrada se
+ * queda sin datos, para que --alert y --preview no esperen a la siguiente
+ * MAP, y atiende las señales y la línea periódica de --stats aunque no
+ * lleguen tramas.
  **************************************************************************/
-class RotorDeMapeo {
-private:
-    NodoRotor* head;     ///< Puntero a la posición 'cero' actual del rotor
-    int size;            ///< Tamaño del rotor (26 letras)
+struct ConsumidorTramas : ReposoLector {
+    Decodificador* deco;     ///< Decodificador de la sesión
+    ListaDeCarga* carga;     ///< Lista de carga (instantáneas bajo demanda)
+    bool usarPoo;            ///< Ruta polimórfica con new/delete por trama
+    bool traza;              ///< Imprimir la traza por trama
+    bool conBanco;           ///< Leer "M,<rotor>,N" para el banco de rotores (--rotors)
+    bool vaciarEnReposo;     ///< Pasar el lote a la lista al quedarse sin entrada (--alert, --preview)
+    int periodoReposoMs;     ///< Cada cuánto volver a enReposo() si la entrada calla (-1 = no)
+    Trama slot;              ///< Trama reutilizable de la ruta por valor
+    char linea[256];         ///< Copia terminada en '\0' para parseLinea()
+    const char* etiqueta;    ///< Prefijo de la traza en --multi (nullptr = ninguno)
+    Estadisticas* est;       ///< Instrumentación (nullptr = desactivada)
+    LatenciaTramas* lat;     ///< Latencia por trama (nullptr = desactivada; solo procesarLinea)
+    unsigned tramasVistas;   ///< Para consultar el reloj de la línea periódica cada 256 tramas
 
-public:
     /**
-     * @brief Constructor - inicializa el rotor con A-Z
-     * @post Rotor circular creado con 26 nodos, head apuntando a 'A'
+     * @brief Constructor
+     * @param d Decodificador de la sesión
+     * @param c Lista de carga de la sesión
+     * @param poo true para usar la jerarquía TramaBase
+     * @param conTraza true en VERB_TRAZA
+     * @param prefijo Etiqueta del flujo en la traza, o nullptr
      */
-    RotorDeMapeo() : head(nullptr), size(0) {
-        // Construir lista circular A..Z
-        NodoRotor* first = nullptr;
-        NodoRotor* prev = nullptr;
-        for (char ch = 'A'; ch <= 'Z'; ++ch) {
-            NodoRotor* n = new NodoRotor(ch);
-            if (!first) first = n;
-            if (prev) {
-                prev->next = n;
-                n->prev = prev;
-            }
-            prev = n;
-            ++size;
-        }
-        // Cerrar la circularidad
-        if (first && prev) {
-            first->prev = prev;
-            prev->next = first;
-            head = first;
-        }
-    }
+    ConsumidorTramas(Decodificador* d, ListaDeCarga* c, bool poo, bool conTraza,
+                     const char* prefijo = nullptr)
+        : deco(d), carga(c), usarPoo(poo), traza(conTraza), conBanco(false),
+          vaciarEnReposo(false), periodoReposoMs(-1), etiqueta(prefijo),
+          est(nullptr), lat(nullptr), tramasVistas(0) {}
 
     /**
-     * @brief Destructor - libera memoria del rotor
-     * @details Rompe la circularidad antes de eliminar para evitar loops infinitos
+     * @brief Marca de tiempo solo si la instrumentación está activa
+     * @return Nanosegundos monótonos, o 0 sin instrumentación
      */
-    ~RotorDeMapeo() {
-        if (!head) return;
-        // Romper circularidad
-        head->prev->next = nullptr;
-        NodoRotor* cur = head;
-        while (cur) {
-            NodoRotor* nx = cur->next;
-            delete cur;
-            cur = nx;
-        }
-    }
+    long long marca() const { return (est || lat) ? relojNs() : 0; }
 
     /**
-     * @brief Rota el rotor N posiciones
-     * @param N Número de posiciones a rotar (+ derecha, - izquierda)
-     * @post head se mueve N posiciones en la lista circular
-     * @details Maneja correctamente rotaciones positivas y negativas usando módulo
+     * @brief Atiende las señales pendientes (SIGUSR2, SIGUSR1) y la línea periódica
+     * @param consultarReloj true para comprobar ya si toca la línea de --stats
      */
-    void rotar(int N) {
-        if (!head || size <= 1) return;
-        
-        // Calcular desplazamiento efectivo
-        int effective = N % size;
-        if (effective < 0) effective += size;
-        
-        // Mover head
-        for (int i = 0; i < effective; ++i) {
-            head = head->next;
+    void revisarInstantanea(bool consultarReloj = false) {
+        if (g_instantanea) {
+            g_instantanea = 0;
+            carga->solicitarInstantanea();
         }
-        
-        cout << " -> ROTANDO ROTOR " << (N >= 0 ? "+" : "") << N 
-             << " (efectivo: +" << effective << ")" << endl;
+        if (!est) return;
+        if (g_volcado) {
+            g_volcado = 0;
+            est->volcarJson();
+        }
+        if (((++tramasVistas & 255) == 0 || consultarReloj) && est->tocaInforme()) est->imprimirLinea();
     }
 
     /**
-     * @brief Obtiene el carácter mapeado según la rotación actual del rotor
-     * @param in Carácter de entrada a decodificar
-     * @return Carácter decodificado según el mapeo actual
-     * @details 
-     * - Los espacios se devuelven sin cambios
-     * - Las minúsculas se convierten a mayúsculas
-     * - El mapeo se realiza encontrando la posición relativa desde head
+     * @brief Indica si enReposo() tiene algo que hacer
+     * @return true con lote por vaciar o con --stats activo
      */
-    char getMapeo(char in) {
-        if (in == ' ') return ' ';
-        
-        // Normalizar a mayúscula
-        if (in >= 'a' && in <= 'z') 
-            in = char(in - 'a' + 'A');
-        
-        if (in < 'A' || in > 'Z') 
-            return in;
-        
-        // Encontrar posición y devolver carácter mapeado
-        int index = in - 'A';
-        NodoRotor* cur = head;
-        for (int i = 0; i < index; ++i) {
-            cur = cur->next;
-        }
-        return cur->c;
-    }
+    bool atiendeReposo() const { return vaciarEnReposo || periodoReposoMs > 0; }
 
     /**
-     * @brief Imprime el estado actual del rotor para debug
-     * @details Muestra las 26 letras desde la posición head
+     * @brief La entrada no tiene más datos por ahora
+     * @details Sin traza los LOAD esperan en el lote del decodificador; al
+     * vaciarlo la lista (y su BuscadorPatrones) ve ya todo lo recibido
      */
-    void imprimirEstado() {
-        if (!head) return;
-        cout << "Estado rotor (desde head): ";
-        NodoRotor* cur = head;
-        for (int i = 0; i < size; ++i) {
-            cout << cur->c;
-            cur = cur->next;
-        }
-        cout << endl;
+    virtual void enReposo() {
+        if (vaciarEnReposo) deco->vaciarLote();
+        revisarInstantanea(true);
     }
-};
-
-/**************************************************************************
- * @class TramaLoad
- * @brief Trama de tipo LOAD que contiene un fragmento de dato
- * 
- * @details
- * Representa una trama "L,X" donde X es un carácter que debe ser decodificado
- * usando el estado actual del rotor y agregado a la lista de carga.
- **************************************************************************/
-class TramaLoad : public TramaBase {
-private:
-    char fragmento;      ///< Carácter a decodificar
 
-public:
     /**
-     * @brief Constructor
-     * @param f Carácter fragmento de la trama
+     * @brief Procesa una línea del protocolo de texto
+     * @param vista Inicio de la línea (sin terminar en '\0')
+     * @param largo Longitud de la línea sin \r\n
      */
-    TramaLoad(char f) : fragmento(f) {}
-    
-    /**
-     * @brief Procesa la trama LOAD
-     * @param carga Lista donde se insertará el fragmento decodificado
-     * @param rotor Rotor usado para decodificar el fragmento
-     * @post El fragmento decodificado se agrega al final de la lista de carga
-     */
-    virtual void procesar(ListaDeCarga* carga, RotorDeMapeo* rotor) {
-        cout << "Trama: [L, " 
-             << (fragmento == ' ' ? "Space" : std::string(1, fragmento)) 
-             << "] -> Procesando...";
-        
-        char dec = rotor->getMapeo(fragmento);
-        
-        cout << " -> Fragmento '" << fragmento 
-             << "' decodificado como '" << dec << "'. ";
+    void procesarLinea(const char* vista, size_t largo) {
+        revisarInstantanea();
+        long long t0 = marca();
+        if (est) est->registrarLinea(largo);
+        if (traza) {
+            if (etiqueta) cout << etiqueta;
+            cout << "Trama recibida: [";
+            cout.write(vista, (std::streamsize)largo);
+            cout << "] ";
+            if (est) {
+                long long t = relojNs();
+                est->registrarSalida(t - t0);
+                t0 = t;
+            }
+        }
         
-        carga->insertarAlFinal(dec);
-        carga->imprimirMensaje();
-    }
-    
-    /**
-     * @brief Destructor
-     */
-    virtual ~TramaLoad() {}
-};
+        if (usarPoo) {
+            // La ruta polimórfica trabaja con una copia terminada en '\0'
+            size_t L = (largo < sizeof(linea) ? largo : sizeof(linea) - 1);
+            memcpy(linea, vista, L);
+            linea[L] = '\0';
 
-/**************************************************************************
- * @class TramaMap
- * @brief Trama de tipo MAP que modifica la rotación del rotor
- * 
- * @details
- * Representa una trama "M,N" donde N es un entero que indica cuántas
- * posiciones debe rotar el rotor (positivo o negativo).
- **************************************************************************/
-class TramaMap : public TramaBase {
-private:
-    int desplazamiento;  ///< Número de posiciones a rotar
+            // Parsear trama
+            TramaBase* trama = parseLinea(linea);
+            long long t1 = marca();
+            if (!trama) {
+                deco->registrarInvalida();
+                if (est) est->registrarTrama(TRAMA_INVALIDA, t1 - t0, 0);
+                if (lat) lat->invalida(t1);
+                if (traza) cout << " -> Trama inválida. Se ignora." << '\n';
+                return;
+            }
+            
+            // Procesar trama (polimorfismo)
+            long loadsAntes = deco->getLoads();
+            deco->procesar(trama);
+            if (est || lat) {
+                long long t2 = relojNs();
+                TipoTrama tipo = deco->getLoads() != loadsAntes ? TRAMA_LOAD : TRAMA_MAP;
+                if (est) est->registrarTrama(tipo, t1 - t0, t2 - t1);
+                if (lat) lat->procesada(tipo, t1, t2);
+            }
+            
+            // Liberar memoria
+            delete trama;
+        } else {
+            // Parsear sobre la ranura reutilizable y despachar por valor
+            bool valida = parsearTrama(vista, largo, slot, traza, conBanco);
+            long long t1 = marca();
+            if (!valida) {
+                deco->registrarInvalida();
+                if (est) est->registrarTrama(TRAMA_INVALIDA, t1 - t0, 0);
+                if (lat) lat->invalida(t1);
+                if (traza) cout << " -> Trama inválida. Se ignora." << '\n';
+                return;
+            }
+            deco->procesar(slot);
+            if (est || lat) {
+                long long t2 = relojNs();
+                if (est) est->registrarTrama(slot.tipo, t1 - t0, t2 - t1);
+                if (lat) lat->procesada(slot.tipo, t1, t2);
+            }
+        }
+        if (traza) cout << '\n';
+    }
 
-public:
-    /**
-     * @brief Constructor
-     * @param d Desplazamiento a aplicar al rotor
-     */
-    TramaMap(int d) : desplazamiento(d) {}
-    
     /**
-     * @brief Procesa la trama MAP
-     * @param carga No se utiliza en tramas MAP
-     * @param rotor Rotor que será rotado
-     * @post El rotor se rota N posiciones
+     * @brief Procesa los registros de un bloque binario ya validado
+     * @param registrosBloque Registros del bloque
+     * @param largo Longitud de los registros
      */
-    virtual void procesar(ListaDeCarga* carga, RotorDeMapeo* rotor) {
-        cout << "Trama: [M," << desplazamiento << "] -> Procesando... ";
-        rotor->rotar(desplazamiento);
-        rotor->imprimirEstado();
+    void procesarBloque(const unsigned char* registrosBloque, size_t largo) {
+        LectorBloque registros(registrosBloque, largo);
+        if (est) est->registrarBloque(largo);
+        long long t0 = marca();
+        while (registros.siguiente(slot)) {
+            revisarInstantanea();
+            long long t1 = marca();
+            if (traza) {
+                if (etiqueta) cout << etiqueta;
+                imprimirTramaRecibida(slot);
+                if (est) {
+                    long long t = relojNs();
+                    est->registrarSalida(t - t1);
+                    t1 = t;
+                }
+            }
+            if (slot.tipo == TRAMA_INVALIDA) {
+                deco->registrarInvalida();
+                if (est) est->registrarTrama(TRAMA_INVALIDA, t1 - t0, 0);
+                if (traza) cout << " -> Registro binario inválido. Se ignora." << '\n';
+                t0 = marca();
+                continue;
+            }
+            if (usarPoo) {
+                TramaBase* trama;
+                if (slot.tipo == TRAMA_LOAD) trama = new TramaLoad(slot.fragmento);
+                else trama = new TramaMap(slot.desplazamiento);
+                deco->procesar(trama);
+                delete trama;
+            } else {
+                deco->procesar(slot);
+            }
+            if (est) est->registrarTrama(slot.tipo, t1 - t0, relojNs() - t1);
+            if (traza) cout << '\n';
+            t0 = marca();
+        }
     }
-    
-    /**
-     * @brief Destructor
-     */
-    virtual ~TramaMap() {}
 };
 
-/**************************************************************************
- * @class SerialReader
- * @brief Clase para leer datos desde puerto serial o archivo de simulación
- * 
- * @details
- * Intenta abrir un puerto serial en Linux. Si falla, intenta abrir como
- * archivo de texto para simulación. Soporta lectura línea por línea.
- **************************************************************************/
-class SerialReader {
-private:
-    FILE* f;             ///< File pointer para lectura
-    bool is_serial;      ///< Indica si es puerto serial real
+/**
+ * @brief Hilo productor del pipeline: drena la fuente hacia el canal
+ * @param reader Lector ya abierto
+ * @param canal Canal hacia el hilo decodificador
+ * @param binario true si la fuente está en formato de bloques
+ * @param ritmo Horario de reproducción (nullptr = tan rápido como se lea)
+ * @post El canal queda cerrado al agotarse la fuente o al pedir detener
+ */
+static void producirLineas(SerialReader* reader, CanalLineas* canal, bool binario,
+                           CadenciaReproduccion* ritmo) {
+    long long pos = reader->posicion();
+    for (;;) {
+        const char* p;
+        size_t L;
+        if (binario) {
+            const unsigned char* b;
+            if (g_detener || !reader->leerBloque(b, L)) break;
+            p = (const char*)b;
+        } else if (g_detener || !reader->leerVista(p, L)) {
+            break;
+        }
+        if (ritmo) {
+            long long sig = reader->posicion();
+            ritmo->esperar(sig - pos);
+            pos = sig;
+        }
+        RanuraLinea* r = canal->reservarEsperando(&g_detener);
+        if (!r) break;
+        if (L > RanuraLinea::CAPACIDAD) L = RanuraLinea::CAPACIDAD;
+        memcpy(r->datos, p, L);
+        r->largo = (unsigned short)L;
+        canal->publicar();
+    }
+    canal->cerrar();
+}
+
+/**
+ * @brief Decodifica con lector y decodificador en hilos separados
+ * @param reader Lector ya abierto
+ * @param consumidor Cuerpo del bucle de decodificación
+ * @param binario true si la fuente está en formato de bloques
+ * @param nivel Verbosidad (en VERB_RESUMEN se informa la contrapresión)
+ * @param ritmo Horario de reproducción del hilo lector, o nullptr
+ * @details El hilo lector solo mueve bytes de la fuente al canal, de modo
+ * que el tty se sigue drenando aunque la salida o el decodificador se
+ * demoren. Las señales se atienden en el hilo lector para que su poll()
+ * despierte con SIGINT/SIGTERM.
+ */
+static void decodificarEnPipeline(SerialReader& reader, ConsumidorTramas& consumidor,
+                                  bool binario, Verbosidad nivel, CadenciaReproduccion* ritmo) {
+    CanalLineas* canal = new CanalLineas();
+    std::thread lector(producirLineas, &reader, canal, binario, ritmo);
 #ifdef __linux__
-    int fd;              ///< File descriptor (Linux)
+    sigset_t bloqueadas;
+    sigemptyset(&bloqueadas);
+    sigaddset(&bloqueadas, SIGINT);
+    sigaddset(&bloqueadas, SIGTERM);
+#ifdef SIGUSR2
+    sigaddset(&bloqueadas, SIGUSR1);
+    sigaddset(&bloqueadas, SIGUSR2);
+#endif
+    pthread_sigmask(SIG_BLOCK, &bloqueadas, nullptr);
 #endif
 
-public:
-    /**
-     * @brief Constructor por defecto
-     */
-    SerialReader() : f(nullptr), is_serial(false)
+    const RanuraLinea* r;
+    const bool reposo = consumidor.atiendeReposo();
+    for (;;) {
+        if (reposo && canal->vacio()) consumidor.enReposo();
+        if (g_detener) break;
+        bool vencido;
+        r = canal->frenteEsperando(consumidor.periodoReposoMs, &vencido);
+        if (vencido) continue;
+        if (!r) break;
+        if (binario) consumidor.procesarBloque((const unsigned char*)r->datos, r->largo);
+        else consumidor.procesarLinea(r->datos, r->largo);
+        canal->liberar();
+    }
+    lector.join();
 #ifdef __linux__
-    , fd(-1)
+    pthread_sigmask(SIG_UNBLOCK, &bloqueadas, nullptr);
 #endif
-    {}
+
+    if (nivel >= VERB_RESUMEN) {
+        cout << "Pipeline: " << canal->getPublicadas() << (binario ? " bloques" : " líneas")
+             << ", ocupación máxima " << canal->getOcupacionMaxima() << "/" << canal->getCapacidad()
+             << ", esperas del lector (canal lleno): " << canal->getEsperasLleno()
+             << ", esperas del decodificador (canal vacío): " << canal->getEsperasVacio() << '\n';
+    }
+    delete canal;
+}
+
+/**
+ * @brief Hilo de --preview: muestra el final del mensaje mientras se decodifica
+ * @param carga Lista con permitirLecturaConcurrente() activo
+ * @param periodoMs Milisegundos entre líneas
+ * @param terminar Se pone a true cuando la decodificación terminó
+ * @details Lee la lista sin cerrojos (ListaDeCarga::copiarUltimos()), así
+ * que no frena al hilo que decodifica. Sin traza, los LOAD llegan a la
+ * lista por lotes: mientras entran datos la vista puede ir hasta un lote
+ * por detrás, y el lote se vacía cuando la entrada se queda sin datos.
+ */
+static void mostrarVistaPrevia(const ListaDeCarga* carga, int periodoMs, const std::atomic<bool>* terminar) {
+    static const size_t ULTIMOS = 64;
+    char buf[ULTIMOS];
+    while (!terminar->load(std::memory_order_acquire)) {
+        // Espera en tramos cortos para terminar en cuanto acabe la sesión
+        for (int t = 0; t < periodoMs && !terminar->load(std::memory_order_acquire); t += 10)
+            std::this_thread::sleep_for(std::chrono::milliseconds(periodoMs - t < 10 ? periodoMs - t : 10));
+        long total;
+        size_t k = carga->copiarUltimos(buf, ULTIMOS, total);
+        fprintf(stderr, "vista previa: %ld fragmentos | %s%.*s\n",
+                total, (size_t)total > k ? "..." : "", (int)k, buf);
+    }
+}
+
+/**
+ * @brief Publica las estadísticas al terminar la sesión
+ * @param est Instrumentación de la sesión
+ * @details Imprime la línea final en stderr y escribe el volcado JSON
+ */
+static void cerrarEstadisticas(Estadisticas& est) {
+    est.imprimirLinea();
+    if (est.tieneDestinoJson() && !est.volcarJson()) cout << "No se pudo escribir el volcado de estadísticas." << endl;
+}
+
+/**
+ * @struct OpcionesFlujo
+ * @brief Opciones de línea de comandos que se aplican a cada flujo de --multi
+ */
+struct OpcionesFlujo {
+    Verbosidad nivel;        ///< Verbosidad de la sesión
+    bool incremental;        ///< Salida incremental de la lista de carga
+    long cadaK;              ///< Periodo de instantáneas en modo incremental
+    int esperaMs;            ///< Inactividad máxima de todos los flujos (-1 = sin límite)
+    int baud;                ///< Velocidad de los puertos seriales
+    bool usarPoo;            ///< Ruta polimórfica TramaBase
+    bool plegarForzado;      ///< Plegar MAP también en modo traza
+    Estadisticas* est;       ///< Instrumentación común (nullptr = desactivada)
+};
+
+/**
+ * @struct FlujoMultiple
+ * @brief Estado independiente de uno de los dispositivos de --multi
+ */
+struct FlujoMultiple {
+    const char* ruta;                 ///< Dispositivo o archivo
+    char etiqueta[16];                ///< Prefijo de la traza: "[i] "
+    SerialReader reader;              ///< Lector propio
+    ListaDeCarga carga;               ///< Mensaje de este flujo
+    RotorActivo rotor;                ///< Rotor de este flujo
+    Decodificador* deco;              ///< Decodificador de este flujo
+    ConsumidorTramas* consumidor;     ///< Cuerpo del bucle para este flujo
+    int formato;                      ///< -1 sin detectar, 0 texto, 1 binario
+    bool activo;                      ///< La fuente aún puede entregar datos
 
     /**
-     * @brief Destructor - cierra puerto/archivo
+     * @brief Constructor - flujo vacío, se completa en decodificarMultiples()
      */
-    ~SerialReader() {
-#ifdef __linux__
-        if (fd != -1) {
-            close(fd);
-        }
-#endif
-        if (f) fclose(f);
-    }
+    FlujoMultiple() : ruta(nullptr), deco(nullptr), consumidor(nullptr),
+                      formato(-1), activo(false) { etiqueta[0] = '\0'; }
 
     /**
-     * @brief Abre un puerto serial o archivo de simulación
-     * @param path Ruta del dispositivo (/dev/ttyUSB0) o archivo
-     * @param baud Baud rate para puerto serial (default: 9600)
-     * @return true si se abrió correctamente
-     * @details Intenta primero como puerto serial (Linux), luego como archivo
+     * @brief Destructor - libera el decodificador del flujo
      */
-    bool abrir(const char* path, int baud = 9600) {
-#ifdef __linux__
-        // Intentar como puerto serial
-        fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
-        if (fd != -1) {
-            struct termios tty;
-            if (tcgetattr(fd, &tty) == 0) {
-                cfmakeraw(&tty);
-                cfsetspeed(&tty, B9600);
-                tty.c_cflag &= ~PARENB;
-                tty.c_cflag &= ~CSTOPB;
-                tty.c_cflag &= ~CSIZE;
-                tty.c_cflag |= CS8;
-                tty.c_cflag |= CREAD;
-                tcsetattr(fd, TCSANOW, &tty);
-                
-                f = fdopen(fd, "r");
-                if (!f) {
-                    close(fd); 
-                    fd = -1;
-                } else {
-                    is_serial = true;
-                    cout << "Conexión serial abierta en " << path << endl;
-                    return true;
-                }
-            } else {
-                close(fd); 
-                fd = -1;
-            }
-        }
-#endif
-        // Fallback: archivo de simulación
-        f = fopen(path, "r");
-        if (!f) {
-            cout << "Error abriendo '" << path << "': " 
-                 << strerror(errno) << endl;
-            return false;
-        }
-        is_serial = false;
-        cout << "Abierto archivo de simulación: " << path << endl;
-        return true;
+    ~FlujoMultiple() {
+        delete consumidor;
+        delete deco;
     }
 
     /**
-     * @brief Lee una línea del puerto/archivo
-     * @param outBuf Buffer de salida
-     * @param maxLen Tamaño máximo del buffer
-     * @return true si se leyó algo
-     * @post outBuf contiene la línea sin \\r\\n
+     * @brief Decodifica lo que ya se recibió de este flujo
+     * @param cuota Máximo de líneas o bloques (para archivos, que siempre están listos)
+     * @return true si se procesó algo
      */
-    bool leerLinea(char* outBuf, size_t maxLen) {
-        if (!f) return false;
-        if (fgets(outBuf, (int)maxLen, f) == nullptr) {
-            return false;
+    bool drenar(long cuota) {
+        if (formato < 0) {
+            // Esperar a tener los dos bytes de la marca para decidir el formato
+            if (reader.bytesPendientes() < 2 && !reader.estaAgotado()) return false;
+            formato = reader.esFormatoBinario() ? 1 : 0;
         }
-        // Eliminar \r\n
-        size_t L = strlen(outBuf);
-        while (L > 0 && (outBuf[L-1] == '\n' || outBuf[L-1] == '\r')) {
-            outBuf[--L] = '\0';
+        long n = 0;
+        if (formato == 1) {
+            const unsigned char* bloque;
+            size_t largo;
+            while (n < cuota && reader.leerBloque(bloque, largo)) {
+                consumidor->procesarBloque(bloque, largo);
+                ++n;
+            }
+        } else {
+            const char* vista;
+            size_t largo;
+            while (n < cuota && reader.leerVista(vista, largo)) {
+                consumidor->procesarLinea(vista, largo);
+                ++n;
+            }
         }
-        return true;
+        return n > 0;
     }
 };
 
-/**************************************************************************
- * Funciones auxiliares
- **************************************************************************/
-
 /**
- * @brief Elimina espacios en blanco al inicio y final de una cadena
- * @param s Cadena a modificar (in-place)
- * @post s contiene la cadena sin espacios al inicio/final
+ * @brief Decodifica varios dispositivos desde un solo hilo con epoll
+ * @param lista Rutas separadas por comas
+ * @param op Opciones comunes a todos los flujos
+ * @return 0 si éxito, 1 si error
+ * @details Cada flujo conserva su propio lector, lista de carga, rotor y
+ * decodificador. Los puertos seriales se atienden cuando epoll indica
+ * datos; los archivos regulares (siempre listos) se intercalan por cuotas.
  */
-void trim(char* s) {
-    // Trim izquierdo
-    int i = 0;
-    while (s[i] && isspace((unsigned char)s[i])) ++i;
-    if (i > 0) memmove(s, s + i, strlen(s + i) + 1);
-    
-    // Trim derecho
-    int L = (int)strlen(s);
-    while (L > 0 && isspace((unsigned char)s[L-1])) 
-        s[--L] = '\0';
-}
+static int decodificarMultiples(const char* lista, const OpcionesFlujo& op) {
+#ifdef __linux__
+    // Separar la lista de rutas sobre una copia
+    size_t largoLista = strlen(lista);
+    char* rutas = new char[largoLista + 1];
+    memcpy(rutas, lista, largoLista + 1);
+    int n = 1;
+    for (size_t i = 0; i < largoLista; ++i)
+        if (rutas[i] == ',') ++n;
 
-/**
- * @brief Parsea una línea de texto y crea la trama correspondiente
- * @param lineaC Línea a parsear (formato: "L,X" o "M,N")
- * @return Puntero a TramaBase* (debe liberarse con delete) o nullptr si inválida
- * @details
- * Formatos válidos:
- * - L,X : TramaLoad con carácter X
- * - L,Space : TramaLoad con espacio
- * - M,N : TramaMap con desplazamiento N (puede ser negativo)
- */
-TramaBase* parseLinea(const char* lineaC) {
-    char buffer[128];
-    strncpy(buffer, lineaC, sizeof(buffer));
-    buffer[sizeof(buffer)-1] = '\0';
-    trim(buffer);
-    
-    if (strlen(buffer) == 0) return nullptr;
-
-    // Tokenizar por coma
-    char* token = strtok(buffer, ",");
-    if (!token) return nullptr;
-    trim(token);
-    if (strlen(token) == 0) return nullptr;
-
-    // Trama LOAD
-    if ((token[0] == 'L' || token[0] == 'l') && (token[1] == '\0')) {
-        char* arg = strtok(nullptr, ",");
-        if (!arg) {
-            cout << "Trama L sin argumento." << endl;
-            return nullptr;
+    FlujoMultiple* flujos = new FlujoMultiple[n];
+    Multiplexor mux;
+    if (!mux.valido()) {
+        cout << "Error creando epoll: " << strerror(errno) << endl;
+        delete[] flujos;
+        delete[] rutas;
+        return 1;
+    }
+    const bool traza = (op.nivel >= VERB_TRAZA);
+    char* p = rutas;
+    int activos = 0;
+    for (int i = 0; i < n; ++i) {
+        char* coma = strchr(p, ',');
+        if (coma) *coma = '\0';
+        FlujoMultiple& f = flujos[i];
+        f.ruta = p;
+        snprintf(f.etiqueta, sizeof(f.etiqueta), "[%d] ", i);
+        f.carga.configurarSalida(op.incremental, op.cadaK);
+        f.carga.fijarVerbosidad(op.nivel);
+        f.rotor.fijarVerbosidad(op.nivel);
+        f.reader.fijarVerbosidad(op.nivel);
+        f.reader.configurarEspera(op.esperaMs, &g_detener);
+        f.deco = new Decodificador(&f.carga, &f.rotor,
+                                   !op.usarPoo && (op.plegarForzado || !traza));
+        f.consumidor = new ConsumidorTramas(f.deco, &f.carga, op.usarPoo, traza, f.etiqueta);
+        f.consumidor->est = op.est;
+        if (op.est) op.est->observar(f.deco, &f.carga);
+        p = coma ? coma + 1 : p + strlen(p);
+
+        if (!*f.ruta || !f.reader.abrir(f.ruta, op.baud)) {
+            cout << "No se pudo abrir ruta: " << f.ruta << endl;
+            continue;
         }
-        trim(arg);
-        
-        // Detectar "Space"
-        if ((arg[0] == 'S' || arg[0] == 's') && (strcasecmp(arg, "Space") == 0)) {
-            return new TramaLoad(' ');
+        f.reader.configurarSinEspera(true);
+        if (!f.reader.estaProyectado() && !mux.agregar(f.reader.descriptor(), i)) {
+            cout << "No se puede vigilar '" << f.ruta << "': " << strerror(errno) << endl;
+            continue;
         }
-        
-        // Carácter único
-        if (strlen(arg) == 1) {
-            return new TramaLoad(arg[0]);
+        f.activo = true;
+        ++activos;
+    }
+    if (op.nivel >= VERB_RESUMEN)
+        cout << activos << " de " << n << " flujos abiertos. Esperando tramas..." << endl << endl;
+
+    const long CUOTA_ARCHIVO = 4096;
+    int sinDatosMs = 0;
+    while (activos > 0 && !g_detener) {
+        // Archivos proyectados: siempre listos, se intercalan por cuotas
+        bool hayArchivos = false;
+        for (int i = 0; i < n; ++i) {
+            FlujoMultiple& f = flujos[i];
+            if (!f.activo || !f.reader.estaProyectado()) continue;
+            if (!f.drenar(CUOTA_ARCHIVO) && f.reader.estaAgotado()) {
+                f.activo = false;
+                --activos;
+            } else {
+                hayArchivos = true;
+            }
         }
-        
-        // Tomar primer carácter
-        if (strlen(arg) > 1) {
-            return new TramaLoad(arg[0]);
+        if (activos == 0) break;
+
+        // Con --stats la espera se parte en tramos para atender el reloj y
+        // SIGUSR1 aunque ningún flujo traiga datos; los tramos suman --timeout
+        int plazo = hayArchivos ? 0 : (op.esperaMs < 0 ? -1 : op.esperaMs - sinDatosMs);
+        bool tramo = !hayArchivos && op.est && (plazo < 0 || plazo > PERIODO_REPOSO_MS);
+        if (tramo) plazo = PERIODO_REPOSO_MS;
+        int k = mux.esperar(plazo);
+        if (k < 0) {
+            if (errno == EINTR) {
+                for (int i = 0; i < n; ++i)
+                    if (flujos[i].activo) flujos[i].consumidor->enReposo();
+                continue;
+            }
+            cout << "Error en epoll_wait: " << strerror(errno) << endl;
+            break;
+        }
+        if (k == 0 && tramo) {
+            sinDatosMs += plazo;
+            for (int i = 0; i < n; ++i)
+                if (flujos[i].activo) flujos[i].consumidor->enReposo();
+            continue;
         }
-        return nullptr;
-    } 
-    // Trama MAP
-    else if ((token[0] == 'M' || token[0] == 'm') && (token[1] == '\0')) {
-        char* arg = strtok(nullptr, ",");
-        if (!arg) {
-            cout << "Trama M sin argumento." << endl;
-            return nullptr;
+        if (k > 0) sinDatosMs = 0;
+        if (k == 0 && !hayArchivos) {
+            if (op.nivel >= VERB_RESUMEN)
+                cout << "Sin datos durante " << op.esperaMs << " ms. Fin de la sesión." << '\n';
+            break;
+        }
+        for (int e = 0; e < k; ++e) {
+            FlujoMultiple& f = flujos[mux.indice(e)];
+            if (!f.activo) continue;
+            bool vivo = f.reader.bombear();
+            f.drenar(CUOTA_ARCHIVO * 16);
+            if (!vivo) {
+                // Entregar lo que quede (última línea sin '\n')
+                while (f.drenar(CUOTA_ARCHIVO)) {}
+                mux.quitar(f.reader.descriptor());
+                f.activo = false;
+                --activos;
+            }
         }
-        trim(arg);
-        int n = atoi(arg);
-        return new TramaMap(n);
-    } 
-    else {
-        cout << "Tipo de trama desconocido: " << token << endl;
-        return nullptr;
     }
+
+    // Mostrar resultado final de cada flujo
+    if (op.nivel >= VERB_RESUMEN)
+        cout << "\n---\nFlujo de datos terminado.\n";
+    for (int i = 0; i < n; ++i) {
+        FlujoMultiple& f = flujos[i];
+        f.deco->acumular(0, 0, f.reader.getBloquesDescartados(), 0);
+        f.deco->finalizar();
+        cout << "== " << f.ruta << " ==" << '\n';
+        long long t0 = op.est ? relojNs() : 0;
+        f.carga.imprimirMensajeFinal();
+        if (op.est) op.est->registrarSalida(relojNs() - t0);
+        if (op.nivel == VERB_RESUMEN) imprimirContadores(*f.deco);
+    }
+    if (op.est) cerrarEstadisticas(*op.est);
+    if (op.nivel >= VERB_RESUMEN)
+        cout << "---\nLiberando memoria... Sistema apagado." << endl;
+
+    delete[] flujos;
+    delete[] rutas;
+    return 0;
+#else
+    (void)lista;
+    (void)op;
+    cout << "--multi solo está disponible en Linux." << endl;
+    return 1;
+#endif
 }
 
+/**************************************************************************
+ * @struct RecursosSesion
+ * @brief Dueño de lo que main() reserva en el heap
+ *
+ * @details
+ * main() tiene muchas salidas tempranas por opciones o archivos inválidos;
+ * al liberar todo en el destructor ninguna de ellas puede olvidar algo.
+ **************************************************************************/
+struct RecursosSesion {
+    char* indicePorDefecto;          ///< "<captura>.idx" si no se dio --index
+    Estadisticas* est;               ///< --stats / --stats-json
+    PuntoControl* control;           ///< --checkpoint
+    BancoRotores* banco;             ///< --rotors
+    CadenciaReproduccion* ritmo;     ///< --replay-rate / --replay-baud
+    LatenciaTramas* lat;             ///< --latency
+
+    /**
+     * @brief Constructor - nada reservado
+     */
+    RecursosSesion() : indicePorDefecto(nullptr), est(nullptr), control(nullptr),
+                       banco(nullptr), ritmo(nullptr), lat(nullptr) {}
+
+    /**
+     * @brief Destructor - libera lo que se haya reservado
+     */
+    ~RecursosSesion() {
+        delete[] indicePorDefecto;
+        delete est;
+        delete control;
+        delete banco;
+        delete ritmo;
+        delete lat;
+    }
+};
+
 /**************************************************************************
  * @brief Función principal del decodificador PRT-7
  * 
@@ -604,6 +863,75 @@ TramaBase* parseLinea(const char* lineaC) {
  * @section args Argumentos
  * - --sim <archivo> : Modo simulación con archivo de texto
  * - --serial <dispositivo> : Modo serial real (Linux)
+ * - --multi <disp1,disp2,...> : Varios dispositivos (o archivos) en un solo
+ *   hilo con epoll; cada uno con su propio rotor y mensaje (Linux)
+ * - --incremental : Cada LOAD imprime solo el fragmento nuevo
+ * - --snapshot <K> : En modo incremental, imprime el mensaje completo cada K fragmentos
+ *   (también bajo demanda enviando SIGUSR2)
+ * - --verbosity <quiet|summary|trace> : Solo el mensaje final / mensaje y
+ *   contadores de tramas / detalle de cada trama (por defecto)
+ * - --poo : Usa la jerarquía polimórfica TramaBase (new/delete por trama)
+ * - --fold-map : Pliega las MAP consecutivas también en modo traza (fuera de
+ *   la traza se pliegan siempre)
+ * - --timeout <ms> : En serial, termina tras ms sin datos (por defecto espera
+ *   indefinidamente; SIGINT/SIGTERM terminan la sesión de forma ordenada)
+ * - --baud <bps> : Velocidad del serial (estándar termios o arbitraria con BOTHER)
+ * - --vmin <bytes> / --vtime <decimas> : Agrupamiento de bytes del kernel (VMIN/VTIME);
+ *   con --multi los puertos se leen sin bloqueo y no se aplican
+ * - --threads <N> : Con --sim sobre un archivo regular, decodifica la captura
+ *   en N hilos (sin traza por trama; el mensaje final es idéntico)
+ * - --pipeline : Lee la fuente en un hilo propio y decodifica en otro, unidos
+ *   por un canal SPSC sin bloqueos (mantiene drenado el tty)
+ * - --stats <seg> : Instrumentación; línea de estado en stderr cada seg
+ *   segundos (0 = solo al final)
+ * - --stats-json <archivo> : Instrumentación; volcado JSON al terminar y al
+ *   recibir SIGUSR1 (con solo --stats, SIGUSR1 vuelca el JSON en stderr)
+ * - --stream <archivo|-> : Escribe el mensaje en el archivo (o en stdout con
+ *   "-") a medida que se decodifica, en bloques de 64 KiB, en lugar de
+ *   guardarlo entero hasta el final; SIGUSR2 vacía el bloque pendiente
+ * - --window <N> : Con --stream, fragmentos que se conservan para la vista
+ *   previa de la traza (por defecto 64)
+ * - --ring <N> : Conserva solo los últimos N fragmentos en una lista de
+ *   capacidad fija reservada al inicio (monitoreo continuo sin crecer en
+ *   memoria); el mensaje final muestra esos N
+ * - --checkpoint <base> : Escribe el mensaje en <base>.msg a medida que se
+ *   decodifica (como --stream) y guarda el estado en <base>.ckpt cada
+ *   --checkpoint-every líneas o bloques (por defecto 10000) y al terminar
+ * - --resume : Con --checkpoint, continúa desde <base>.ckpt: rotor,
+ *   contadores y posición en la entrada (en serial, solo rotor y contadores)
+ * - --build-index <K> : Con --sim, escribe el índice de la captura (una
+ *   entrada cada K tramas) y termina sin decodificar
+ * - --from <N> / --to <M> : Con --sim, decodifica solo las tramas N..M-1
+ *   (la primera línea es la trama 0), saltando con el índice si existe
+ * - --index <archivo> : Índice de --build-index / --from (por defecto
+ *   <captura>.idx)
+ * - --rotors <N> : Decodifica con un banco de N rotores en cascada (1..8);
+ *   "M,<rotor>,<D>" gira el rotor indicado y "M,<D>" el rotor 0
+ * - --stepping <none|odometer> : Con --rotors, regla de avance: solo las MAP
+ *   mueven los rotores (por defecto) o cada LOAD avanza el rotor 0 y cada
+ *   vuelta completa arrastra al siguiente
+ * - --async-output : La consola se escribe desde un hilo aparte con writev,
+ *   en buffers de 64 KiB, para que una terminal o tubería lenta no frene la
+ *   decodificación (Linux)
+ * - --latency : Mide cada trama de texto desde la llegada de sus bytes hasta
+ *   el vaciado de su salida y escribe en stderr p50/p99/p999 por etapa
+ * - --latency-trace <archivo> : Como --latency y además exporta las tramas
+ *   lentas como Chrome trace JSON (chrome://tracing o Perfetto)
+ * - --slow-us <N> : Latencia total a partir de la cual una trama es lenta
+ *   (por defecto 1000 µs)
+ * - --alert <palabra> : Avisa en stderr cada vez que la palabra aparece en el
+ *   mensaje, en cuanto llega su último fragmento (se puede repetir)
+ * - --alert-file <archivo> : Como --alert con cada línea del archivo
+ * - --replay-rate <tramas/s> : Con --sim, precarga la captura y entrega las
+ *   tramas a ese ritmo; al final informa en stderr el ritmo logrado y el
+ *   retraso sobre el horario (p50/p99/p999)
+ * - --replay-baud <bps> : Como --replay-rate, pero con el tiempo que tardan
+ *   los bytes de cada trama en un serial 8N1 a esa velocidad
+ * - --preview <ms> : Un hilo aparte escribe en stderr cada ms milisegundos
+ *   el final del mensaje parcial, leyéndolo sin detener la decodificación
+ *
+ * El formato de la entrada se detecta solo: si empieza con la marca de
+ * sincronía 0xA7 0x5A se lee en bloques binarios (ver binario.h y prt7conv).
  * 
  * @section ejemplo Ejemplo de uso
  * @code
@@ -612,15 +940,37 @@ TramaBase* parseLinea(const char* lineaC) {
  * @endcode
  **************************************************************************/
 int main(int argc, char** argv) {
-    cout << "Iniciando Decodificador PRT-7. Preparando estructuras..." << endl;
-    
+    // Salida con buffer propio: la traza no se vacía en cada línea
+    static char bufferSalida[1 << 16];
+    std::ios::sync_with_stdio(false);
+    cout.rdbuf()->pubsetbuf(bufferSalida, sizeof(bufferSalida));
+#ifdef __linux__
+    // Declarada antes que el resto: se destruye al final y vacía lo pendiente
+    SalidaAsincrona salidaAsincrona;
+    bool asincrona = false;
+#endif
+
     ListaDeCarga miCarga;
-    RotorDeMapeo miRotor;
+    RotorActivo miRotor;
+    BuscadorPatrones alertas;
+    RecursosSesion sesion;
 
     // Validar argumentos
     if (argc < 2) {
+        cout << "Iniciando Decodificador PRT-7. Preparando estructuras..." << endl;
         cout << "Uso: " << argv[0] 
-             << " --sim <archivo_simulacion>   (o)  --serial <dispositivo>" << endl;
+             << " --sim <archivo_simulacion>   (o)  --serial <dispositivo>  [opciones]" << endl;
+        cout << "     " << argv[0] << " --multi <disp1,disp2,...>  [opciones]" << endl;
+        cout << "Opciones: --incremental  --snapshot <K>  --poo  --fold-map  --timeout <ms>" << endl;
+        cout << "          --baud <bps>  --vmin <bytes>  --vtime <decimas>" << endl;
+        cout << "          --verbosity <quiet|summary|trace>  --threads <N>  --pipeline" << endl;
+        cout << "          --stats <seg>  --stats-json <archivo>  --stream <archivo|->  --window <N>" << endl;
+        cout << "          --checkpoint <base>  --checkpoint-every <N>  --resume" << endl;
+        cout << "          --build-index <K>  --from <N>  --to <M>  --index <archivo>" << endl;
+        cout << "          --rotors <N>  --stepping <none|odometer>  --async-output  --ring <N>" << endl;
+        cout << "          --latency  --latency-trace <archivo>  --slow-us <N>" << endl;
+        cout << "          --alert <palabra>  --alert-file <archivo>" << endl;
+        cout << "          --replay-rate <tramas/s>  --replay-baud <bps>  --preview <ms>" << endl;
         cout << "Ejemplo de archivo_simulacion (lineas): "
              << "L,H  L,O  L,L  M,2  L,A  L,Space  L,W  M,-2  L,O  L,R  L,L  L,D" << endl;
         cout << "Saliendo (ningún archivo ni serial especificado)." << endl;
@@ -632,43 +982,516 @@ int main(int argc, char** argv) {
     
     SerialReader reader;
     if (!ruta) {
+        cout << "Iniciando Decodificador PRT-7. Preparando estructuras..." << endl;
         cout << "Falta ruta (archivo o dispositivo)." << endl;
         return 1;
     }
 
+    // Opciones adicionales
+    bool incremental = false;
+    long cadaK = 0;
+    int esperaMs = -1;
+    int baud = 9600;
+    int vmin = 1;
+    int vtime = 0;
+    Verbosidad nivel = VERB_TRAZA;
+    bool plegarForzado = false;
+    int hilos = 1;
+    bool pipeline = false;
+    double statsSeg = -1;
+    const char* rutaJson = nullptr;
+    const char* rutaFlujo = nullptr;
+    long ventana = 64;
+    long capacidadAnillo = 0;
+    const char* baseControl = nullptr;
+    long cadaControl = 10000;
+    bool reanudar = false;
+    long long cadaIndice = 0;
+    long long desde = 0;
+    long long hasta = -1;
+    const char* rutaIndice = nullptr;
+    int rotores = 0;
+    ReglaPaso regla = PASO_NINGUNO;
+    bool latencia = false;
+    const char* rutaLatencia = nullptr;
+    long long lentaUs = 1000;
+    double ritmoTramas = 0;
+    long ritmoBaudios = 0;
+    int vistaMs = 0;
+#ifdef PRT7_CURSO
+    bool usarPoo = true;
+#else
+    bool usarPoo = false;
+#endif
+    for (int i = 3; i < argc; ++i) {
+        if (strcmp(argv[i], "--incremental") == 0) {
+            incremental = true;
+        } else if (strcmp(argv[i], "--poo") == 0) {
+            usarPoo = true;
+        } else if (strcmp(argv[i], "--fold-map") == 0) {
+            plegarForzado = true;
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            statsSeg = atof(argv[++i]);
+            if (statsSeg < 0) statsSeg = 0;
+        } else if (strcmp(argv[i], "--stats-json") == 0 && i + 1 < argc) {
+            rutaJson = argv[++i];
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            rutaFlujo = argv[++i];
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            ventana = atol(argv[++i]);
+            if (ventana < 1) ventana = 1;
+        } else if (strcmp(argv[i], "--ring") == 0 && i + 1 < argc) {
+            capacidadAnillo = atol(argv[++i]);
+            if (capacidadAnillo < 1) capacidadAnillo = 1;
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            baseControl = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0 && i + 1 < argc) {
+            cadaControl = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            reanudar = true;
+        } else if (strcmp(argv[i], "--build-index") == 0 && i + 1 < argc) {
+            cadaIndice = atoll(argv[++i]);
+            if (cadaIndice < 1) cadaIndice = 1;
+        } else if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            desde = atoll(argv[++i]);
+            if (desde < 0) desde = 0;
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            hasta = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc) {
+            rutaIndice = argv[++i];
+        } else if (strcmp(argv[i], "--rotors") == 0 && i + 1 < argc) {
+            rotores = atoi(argv[++i]);
+            if (rotores < 1 || rotores > BancoRotores::MAX_ROTORES) {
+                cout << "--rotors admite de 1 a " << BancoRotores::MAX_ROTORES << " rotores." << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--stepping") == 0 && i + 1 < argc) {
+            const char* v = argv[++i];
+            if (strcmp(v, "none") == 0) regla = PASO_NINGUNO;
+            else if (strcmp(v, "odometer") == 0) regla = PASO_ODOMETRO;
+            else {
+                cout << "Regla de avance desconocida: " << v << endl;
+                return 1;
+            }
+#ifdef __linux__
+        } else if (strcmp(argv[i], "--async-output") == 0) {
+            asincrona = true;
+#endif
+        } else if (strcmp(argv[i], "--alert") == 0 && i + 1 < argc) {
+            ++i;
+            alertas.agregar(argv[i], strlen(argv[i]));
+        } else if (strcmp(argv[i], "--alert-file") == 0 && i + 1 < argc) {
+            if (!cargarPatrones(alertas, argv[++i])) {
+                cout << "No se pudo abrir '" << argv[i] << "': " << strerror(errno) << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--replay-rate") == 0 && i + 1 < argc) {
+            ritmoTramas = atof(argv[++i]);
+            ritmoBaudios = 0;
+            if (ritmoTramas <= 0) {
+                cout << "--replay-rate requiere un ritmo positivo." << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--replay-baud") == 0 && i + 1 < argc) {
+            ritmoBaudios = atol(argv[++i]);
+            ritmoTramas = 0;
+            if (ritmoBaudios <= 0) {
+                cout << "--replay-baud requiere una velocidad positiva." << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--preview") == 0 && i + 1 < argc) {
+            vistaMs = atoi(argv[++i]);
+            if (vistaMs < 1) vistaMs = 1;
+        } else if (strcmp(argv[i], "--latency") == 0) {
+            latencia = true;
+        } else if (strcmp(argv[i], "--latency-trace") == 0 && i + 1 < argc) {
+            latencia = true;
+            rutaLatencia = argv[++i];
+        } else if (strcmp(argv[i], "--slow-us") == 0 && i + 1 < argc) {
+            lentaUs = atoll(argv[++i]);
+            if (lentaUs < 0) lentaUs = 0;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            pipeline = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            hilos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            cadaK = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            esperaMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc) {
+            baud = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--vmin") == 0 && i + 1 < argc) {
+            vmin = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--vtime") == 0 && i + 1 < argc) {
+            vtime = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verbosity") == 0 && i + 1 < argc) {
+            const char* v = argv[++i];
+            if (strcmp(v, "quiet") == 0) nivel = VERB_SILENCIO;
+            else if (strcmp(v, "summary") == 0) nivel = VERB_RESUMEN;
+            else if (strcmp(v, "trace") == 0) nivel = VERB_TRAZA;
+            else {
+                cout << "Verbosidad desconocida: " << v << endl;
+                return 1;
+            }
+        } else {
+            cout << "Opción desconocida: " << argv[i] << endl;
+            return 1;
+        }
+    }
+#ifdef __linux__
+    if (asincrona) salidaAsincrona.activar();
+#endif
+    if (nivel >= VERB_RESUMEN)
+        cout << "Iniciando Decodificador PRT-7. Preparando estructuras..." << endl;
+    if (baseControl && (rutaFlujo || pipeline || hilos > 1 || strcmp(modo, "--multi") == 0)) {
+        cout << "--checkpoint no se puede combinar con --stream, --pipeline, --threads ni --multi." << endl;
+        return 1;
+    }
+    if (capacidadAnillo > 0 && (rutaFlujo || baseControl || strcmp(modo, "--multi") == 0)) {
+        cout << "--ring no se puede combinar con --stream, --checkpoint ni --multi." << endl;
+        return 1;
+    }
+    if (latencia && (pipeline || hilos > 1 || strcmp(modo, "--multi") == 0)) {
+        cout << "--latency no se puede combinar con --pipeline, --threads ni --multi." << endl;
+        return 1;
+    }
+    const bool reproducir = (ritmoTramas > 0 || ritmoBaudios > 0);
+    if (reproducir && (strcmp(modo, "--sim") != 0 || hilos > 1)) {
+        cout << "--replay-rate y --replay-baud requieren --sim y no se combinan con --threads." << endl;
+        return 1;
+    }
+    if (vistaMs > 0 && (rutaFlujo || capacidadAnillo > 0 || baseControl || strcmp(modo, "--multi") == 0)) {
+        // Esos modos reciclan los nodos que un lector concurrente podría estar recorriendo
+        cout << "--preview no se puede combinar con --stream, --ring, --checkpoint ni --multi." << endl;
+        return 1;
+    }
+    if (alertas.getPatrones() > 0 && strcmp(modo, "--multi") == 0) {
+        cout << "--alert no está disponible con --multi." << endl;
+        return 1;
+    }
+    if (reanudar && !baseControl) {
+        cout << "--resume requiere --checkpoint <base>." << endl;
+        return 1;
+    }
+    const bool tramo = (desde > 0 || hasta >= 0);
+    if ((tramo || cadaIndice > 0) && (strcmp(modo, "--sim") != 0 || baseControl || pipeline || hilos > 1)) {
+        cout << "--build-index y --from/--to requieren --sim y no se combinan con "
+                "--checkpoint, --pipeline ni --threads." << endl;
+        return 1;
+    }
+    if (regla != PASO_NINGUNO && rotores == 0) rotores = 1;
+    if (rotores > 0 && (tramo || cadaIndice > 0 || baseControl || hilos > 1
+                        || strcmp(modo, "--multi") == 0)) {
+        cout << "--rotors no se puede combinar con --checkpoint, --threads, --multi, "
+                "--build-index ni --from/--to." << endl;
+        return 1;
+    }
+    if (rotores > 0 && usarPoo) {
+        // La jerarquía TramaBase solo conoce el rotor único
+        if (nivel >= VERB_RESUMEN)
+            cout << "--rotors usa la ruta por valor; se ignora --poo." << endl;
+        usarPoo = false;
+    }
+    if (!rutaIndice && (cadaIndice > 0 || tramo)) {
+        sesion.indicePorDefecto = new char[strlen(ruta) + 5];
+        strcpy(sesion.indicePorDefecto, ruta);
+        strcat(sesion.indicePorDefecto, ".idx");
+        rutaIndice = sesion.indicePorDefecto;
+    }
+
+    miCarga.configurarSalida(incremental, cadaK);
+    if (alertas.getPatrones() > 0) {
+        alertas.compilar();
+        miCarga.vigilar(&alertas);
+    }
+    miCarga.fijarVerbosidad(nivel);
+    miRotor.fijarVerbosidad(nivel);
+    reader.fijarVerbosidad(nivel);
+#ifdef SIGUSR2
+    instalarManejador(SIGUSR2, manejarInstantanea);
+#endif
+    instalarManejador(SIGINT, manejarDetener);
+    instalarManejador(SIGTERM, manejarDetener);
+
+    // Instrumentación opcional: sin --stats ni --stats-json no se mide nada
+    Estadisticas*& est = sesion.est;
+    if (statsSeg >= 0 || rutaJson) {
+        est = new Estadisticas(statsSeg > 0 ? statsSeg : 0, rutaJson);
+#ifdef SIGUSR1
+        instalarManejador(SIGUSR1, manejarVolcado);
+#endif
+    }
+    reader.configurarEspera(esperaMs, &g_detener);
+    reader.configurarLectura(vmin, vtime);
+    reader.fijarMarcaLlegada(latencia);
+
+    if (strcmp(modo, "--multi") == 0) {
+        if (rutaFlujo) {
+            cout << "--stream no está disponible con --multi." << endl;
+            return 1;
+        }
+        OpcionesFlujo op;
+        op.nivel = nivel;
+        op.incremental = incremental;
+        op.cadaK = cadaK;
+        op.esperaMs = esperaMs;
+        op.baud = baud;
+        op.usarPoo = usarPoo;
+        op.plegarForzado = plegarForzado;
+        op.est = est;
+        int r = decodificarMultiples(ruta, op);
+        return r;
+    }
+
     // Abrir conexión
-    bool opened = reader.abrir(ruta);
+    bool opened = reader.abrir(ruta, baud);
     if (!opened) {
         cout << "No se pudo abrir ruta: " << ruta << endl;
         return 1;
     }
 
-    cout << "Conexión establecida. Esperando tramas..." << endl << endl;
+    // Modo flujo: el mensaje sale por bloques y la lista retiene solo la ventana
+    FILE* salidaFlujo = nullptr;
+    PuntoControl*& control = sesion.control;
+    EstadoControl previo;
+    if (baseControl) {
+        control = new PuntoControl(baseControl, cadaControl);
+        if (reanudar && !control->leer(previo)) {
+            if (nivel >= VERB_RESUMEN)
+                cout << "Sin punto de control en '" << control->getRutaEstado()
+                     << "'; se empieza desde el principio." << endl;
+            reanudar = false;
+        }
+        salidaFlujo = control->abrirMensaje(reanudar, previo.longitud);
+        if (!salidaFlujo) {
+            cout << "No se pudo abrir '" << control->getRutaMensaje() << "': " << strerror(errno) << endl;
+            return 1;
+        }
+        miCarga.configurarFlujo(salidaFlujo, ventana);
+        miCarga.fijarLongitudPrevia(previo.longitud);
+    } else if (rutaFlujo) {
+        salidaFlujo = (strcmp(rutaFlujo, "-") == 0 ? stdout : fopen(rutaFlujo, "w"));
+        if (!salidaFlujo) {
+            cout << "No se pudo abrir '" << rutaFlujo << "': " << strerror(errno) << endl;
+            return 1;
+        }
+        miCarga.configurarFlujo(salidaFlujo, ventana);
+    } else if (capacidadAnillo > 0) {
+        // Monitoreo continuo: memoria fija con los últimos fragmentos
+        miCarga.configurarAnillo(capacidadAnillo);
+    }
+
+    if (nivel >= VERB_RESUMEN)
+        cout << "Conexión establecida. Esperando tramas..." << endl << endl;
 
     // Bucle principal de procesamiento
-    char linea[256];
-    while (reader.leerLinea(linea, sizeof(linea))) {
-        cout << "Trama recibida: [" << linea << "] ";
-        
-        // Parsear trama
-        TramaBase* trama = parseLinea(linea);
-        if (!trama) {
-            cout << " -> Trama inválida. Se ignora." << endl;
-            continue;
+    const bool traza = (nivel >= VERB_TRAZA);
+    // Sin traza no hay nada que reportar por cada MAP: se pliegan siempre
+    Decodificador deco(&miCarga, &miRotor, !usarPoo && (plegarForzado || !traza));
+    BancoRotores*& banco = sesion.banco;
+    if (rotores > 0) {
+        banco = new BancoRotores(rotores, regla);
+        banco->fijarVerbosidad(nivel);
+        deco.usarBanco(banco);
+        if (nivel >= VERB_RESUMEN)
+            cout << "Banco de " << rotores << " rotores"
+                 << (regla == PASO_ODOMETRO ? " con avance de odómetro" : "") << "." << '\n';
+    }
+
+    // Formato de la fuente: texto por líneas o bloques binarios
+    const bool binario = reader.esFormatoBinario();
+    if (binario && nivel >= VERB_RESUMEN)
+        cout << "Formato binario detectado." << '\n';
+
+    // Índice de acceso aleatorio: se construye y se termina
+    if (cadaIndice > 0) {
+        const char* datos;
+        size_t tam;
+        int r = 1;
+        if (binario || !reader.datosProyectados(datos, tam)) {
+            cout << "--build-index requiere una captura de texto en un archivo regular." << endl;
+        } else {
+            long long tramas = 0;
+            long long entradas = IndiceCaptura::construir(datos, tam, cadaIndice,
+                                                          miRotor.getTamano(), rutaIndice, tramas);
+            if (entradas < 0) {
+                cout << "Error escribiendo '" << rutaIndice << "': " << strerror(errno) << endl;
+            } else {
+                cout << "Índice '" << rutaIndice << "': " << entradas << " entradas cada "
+                     << cadaIndice << " tramas (" << tramas << " tramas)." << endl;
+                r = 0;
+            }
         }
-        
-        // Procesar trama (polimorfismo)
-        trama->procesar(&miCarga, &miRotor);
-        
-        // Liberar memoria
-        delete trama;
-        cout << endl;
+        return r;
+    }
+
+    // Tramo --from/--to: rotor y lectura en el estado previo a la trama desde
+    long long restantes = -1;
+    if (tramo) {
+        if (binario) {
+            cout << "--from/--to requieren una captura de texto." << endl;
+            return 1;
+        }
+        long long previos = posicionarEnTrama(reader, miRotor, desde, rutaIndice, nivel);
+        restantes = (hasta >= 0 ? (hasta > desde ? hasta - desde : 0) : -1);
+        if (nivel >= VERB_RESUMEN) {
+            cout << "Decodificando desde la trama " << desde;
+            if (hasta >= 0) cout << " hasta la " << hasta << " (sin incluirla)";
+            cout << "; el tramo empieza en el fragmento " << previos << " del mensaje." << '\n';
+        }
+    }
+
+    // Reanudación: el estado se restaura sin volver a decodificar el historial
+    if (reanudar) {
+        miRotor.fijarOffset(previo.posicionRotor);
+        deco.acumular(previo.loads, previo.maps, previo.invalidas, previo.rotaciones);
+        bool salto = reader.reposicionar(previo.bytes);
+        if (nivel >= VERB_RESUMEN) {
+            cout << "Reanudando tras la trama " << previo.secuencia << " ("
+                 << previo.longitud << " fragmentos";
+            if (salto) cout << ", byte " << previo.bytes << " de la entrada";
+            cout << ")." << '\n';
+        }
+    }
+
+    // Decodificación paralela de una captura proyectada en memoria
+    const char* captura;
+    size_t tamCaptura;
+    bool secuencial = !binario;
+    if (hilos > 1 && !usarPoo && secuencial && strcmp(modo, "--sim") == 0
+        && reader.datosProyectados(captura, tamCaptura)) {
+        if (traza)
+            cout << "Decodificando con " << hilos << " hilos (sin traza por trama)." << '\n';
+        long loads, maps, invalidas, rotaciones;
+        decodificarParalelo(captura, tamCaptura, hilos, miCarga, miRotor,
+                            loads, maps, invalidas, rotaciones);
+        deco.acumular(loads, maps, invalidas, rotaciones);
+        if (est) est->acumular(loads, maps, invalidas);
+        secuencial = false;
+    } else if (hilos > 1 && nivel >= VERB_RESUMEN) {
+        cout << "--threads requiere --sim con un archivo regular; se decodifica en un hilo." << '\n';
+    }
+
+    // Reproducción a ritmo: la captura entera en memoria antes de empezar
+    CadenciaReproduccion*& ritmo = sesion.ritmo;
+    if (reproducir && !reader.precargar()) {
+        cout << "--replay-rate y --replay-baud requieren una captura en un archivo regular." << endl;
+        return 1;
+    }
+    if (reproducir) ritmo = new CadenciaReproduccion(ritmoTramas, ritmoBaudios, &g_detener);
+
+    // Vista previa: lector concurrente de la lista, sin cerrojos
+    std::atomic<bool> finVista(false);
+    std::thread vista;
+    if (vistaMs > 0 && miCarga.permitirLecturaConcurrente())
+        vista = std::thread(mostrarVistaPrevia, &miCarga, vistaMs, &finVista);
+
+    ConsumidorTramas consumidor(&deco, &miCarga, usarPoo, traza);
+    consumidor.est = est;
+    consumidor.conBanco = (banco != nullptr);
+    consumidor.vaciarEnReposo = alertas.getPatrones() > 0 || vista.joinable();
+    // Con --stats, la línea periódica y SIGUSR1 no esperan a la siguiente trama
+    if (est) consumidor.periodoReposoMs = PERIODO_REPOSO_MS;
+    // En el pipeline el lector corre en otro hilo: ahí el aviso lo da el canal
+    if (consumidor.atiendeReposo() && !pipeline)
+        reader.fijarReposo(&consumidor, consumidor.periodoReposoMs);
+    if (est) est->observar(&deco, &miCarga);
+    LatenciaTramas*& lat = sesion.lat;
+    if (latencia && binario) {
+        if (nivel >= VERB_RESUMEN)
+            cout << "--latency solo mide el protocolo de texto; se ignora." << '\n';
+    } else if (latencia) {
+        lat = new LatenciaTramas(lentaUs, rutaLatencia);
+        consumidor.lat = lat;
+    }
+    if (pipeline && (secuencial || binario)) {
+        decodificarEnPipeline(reader, consumidor, binario, nivel, ritmo);
+    } else if (binario) {
+        // Bucle de bloques binarios: cada registro equivale a una línea de texto
+        const unsigned char* bloque;
+        size_t largoBloque;
+        long long pos = reader.posicion();
+        while (!g_detener && reader.leerBloque(bloque, largoBloque)) {
+            if (ritmo) {
+                long long sig = reader.posicion();
+                if (ritmo->tocaEsperar(sig - pos)) consumidor.enReposo();
+                ritmo->esperar(sig - pos);
+                pos = sig;
+            }
+            consumidor.procesarBloque(bloque, largoBloque);
+            if (control && control->tocaGuardar())
+                guardarPuntoControl(*control, deco, miCarga, reader);
+        }
+    } else {
+        const char* vista;
+        size_t largo;
+        long long pos = reader.posicion();
+        while (secuencial && restantes != 0 && !g_detener && reader.leerVista(vista, largo)) {
+            if (restantes > 0) --restantes;
+            if (ritmo) {
+                // Como en un enlace real, la salida se vacía antes de esperar la trama
+                long long sig = reader.posicion();
+                if (ritmo->tocaEsperar(sig - pos)) {
+                    if (lat) lat->vaciarSalida();
+                    consumidor.enReposo();
+                }
+                ritmo->esperar(sig - pos);
+                pos = sig;
+            }
+            if (lat) lat->llegada(ritmo ? ritmo->getUltimaEntregaNs() : reader.getLlegadaNs());
+            consumidor.procesarLinea(vista, largo);
+            // La salida se vacía antes de que la próxima lectura pueda bloquearse
+            if (lat && !reader.hayLineaCompleta()) lat->vaciarSalida();
+            if (control && control->tocaGuardar())
+                guardarPuntoControl(*control, deco, miCarga, reader);
+        }
+    }
+    if (lat) lat->vaciarSalida();
+    deco.acumular(0, 0, reader.getBloquesDescartados(), 0);
+    deco.finalizar();
+    if (vista.joinable()) {
+        finVista.store(true, std::memory_order_release);
+        vista.join();
     }
 
     // Mostrar resultado final
-    cout << "\n---\nFlujo de datos terminado.\n";
+    if (nivel >= VERB_RESUMEN)
+        cout << "\n---\nFlujo de datos terminado.\n";
+    long long t0 = est ? relojNs() : 0;
     miCarga.imprimirMensajeFinal();
-    cout << "---\nLiberando memoria... Sistema apagado." << endl;
+    if (est) est->registrarSalida(relojNs() - t0);
+    if (control) {
+        guardarPuntoControl(*control, deco, miCarga, reader);
+    } else if (salidaFlujo && salidaFlujo != stdout && fclose(salidaFlujo) != 0) {
+        cout << "Error escribiendo '" << rutaFlujo << "'" << endl;
+    }
+    if (nivel == VERB_RESUMEN) imprimirContadores(deco);
+    if (nivel == VERB_RESUMEN && alertas.getPatrones() > 0) imprimirAlertas(alertas);
+    if (banco && nivel == VERB_RESUMEN)
+        cout << "Tabla compuesta del banco recalculada " << banco->getRecalculos() << " veces.\n";
+#ifdef __linux__
+    if (asincrona && nivel == VERB_RESUMEN) {
+        // Los contadores del escritor solo son válidos con el hilo terminado
+        long esperas = salidaAsincrona.getEsperasLleno();
+        salidaAsincrona.terminar();
+        cout << "Salida asíncrona: " << salidaAsincrona.getBytes() << " bytes en "
+             << salidaAsincrona.getLlamadas() << " llamadas a writev, "
+             << esperas << " esperas por buffer lleno.\n";
+    }
+#endif
+    if (nivel >= VERB_RESUMEN)
+        cout << "---\nLiberando memoria... Sistema apagado." << endl;
+    if (est) {
+        cerrarEstadisticas(*est);
+    }
+    if (lat) {
+        lat->imprimirResumen();
+        if (lat->tieneDestinoTraza() && lat->escribirTraza() < 0)
+            cout << "Error escribiendo '" << rutaLatencia << "': " << strerror(errno) << endl;
+    }
+    if (ritmo) {
+        ritmo->imprimirResumen();
+    }
 
     return 0;
 }
\ No newline at end of file
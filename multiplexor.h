@@ -0,0 +1,94 @@
+/**
+ * @file multiplexor.h
+ * @brief Espera simultánea sobre varios descriptores con epoll
+ *
+ * @details
+ * Envoltorio mínimo de epoll para el modo --multi: un solo hilo atiende
+ * varios puertos seriales y decodifica cada uno cuando tiene datos. Solo
+ * está disponible en Linux.
+ */
+
+#ifndef PRT7_MULTIPLEXOR_H
+#define PRT7_MULTIPLEXOR_H
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+
+/**************************************************************************
+ * @class Multiplexor
+ * @brief Conjunto de descriptores vigilados con epoll
+ *
+ * @details
+ * Cada descriptor se registra con un índice (la posición del flujo en el
+ * arreglo del llamador), que es lo que devuelve indice() para cada evento.
+ **************************************************************************/
+class Multiplexor {
+private:
+    static const int MAX_EVENTOS = 64;       ///< Eventos atendidos por espera
+    int ep;                                  ///< Descriptor de epoll
+    struct epoll_event eventos[MAX_EVENTOS]; ///< Eventos de la última espera
+
+public:
+    /**
+     * @brief Constructor - crea la instancia de epoll
+     */
+    Multiplexor() : ep(epoll_create1(EPOLL_CLOEXEC)) {}
+
+    /**
+     * @brief Destructor - cierra la instancia de epoll
+     */
+    ~Multiplexor() {
+        if (ep != -1) close(ep);
+    }
+
+    /**
+     * @brief Indica si epoll se pudo crear
+     * @return true si el multiplexor es utilizable
+     */
+    bool valido() const { return ep != -1; }
+
+    /**
+     * @brief Registra un descriptor para lectura
+     * @param fd Descriptor a vigilar
+     * @param indice Valor que identificará sus eventos
+     * @return false si epoll no admite el descriptor (p. ej. archivo regular)
+     */
+    bool agregar(int fd, int indice) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = 0;
+        ev.data.u32 = (unsigned)indice;
+        return epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    /**
+     * @brief Deja de vigilar un descriptor
+     * @param fd Descriptor registrado con agregar()
+     */
+    void quitar(int fd) {
+        struct epoll_event ev;
+        epoll_ctl(ep, EPOLL_CTL_DEL, fd, &ev);
+    }
+
+    /**
+     * @brief Espera a que algún descriptor tenga datos
+     * @param timeoutMs Plazo máximo (-1 = sin límite, 0 = no esperar)
+     * @return Número de eventos, 0 si venció el plazo, -1 si una señal
+     * interrumpió la espera o hubo un error (ver errno)
+     */
+    int esperar(int timeoutMs) {
+        return epoll_wait(ep, eventos, MAX_EVENTOS, timeoutMs);
+    }
+
+    /**
+     * @brief Índice del flujo asociado a un evento
+     * @param i Evento (0..esperar()-1)
+     * @return Índice pasado a agregar()
+     */
+    int indice(int i) const { return (int)eventos[i].data.u32; }
+};
+#endif // __linux__
+
+#endif // PRT7_MULTIPLEXOR_H
@@ -0,0 +1,199 @@
+/**
+ * @file paralelo.h
+ * @brief Decodificación paralela de capturas completas en memoria
+ *
+ * @details
+ * El estado del rotor antes de cualquier LOAD es la suma de todos los
+ * desplazamientos MAP anteriores módulo el tamaño del rotor. Por eso una
+ * captura puede dividirse en tramos: cada hilo calcula la rotación neta de
+ * su tramo, un barrido de prefijos exclusivo da la rotación inicial de cada
+ * tramo, y luego cada hilo decodifica su tramo en su propia ListaDeCarga,
+ * que finalmente se empalman en orden.
+ */
+
+#ifndef PRT7_PARALELO_H
+#define PRT7_PARALELO_H
+
+#include <cstring>
+#include <thread>
+
+#include "estructuras.h"
+#include "tramas.h"
+#include "decodificador.h"
+
+/**
+ * @struct TramoCaptura
+ * @brief Porción de la captura asignada a un hilo
+ */
+struct TramoCaptura {
+    const char* ini;         ///< Primer byte del tramo (inicio de línea)
+    const char* fin;         ///< Fin del tramo (tras un '\n' o fin de captura)
+    int rotacionNeta;        ///< Suma de los MAP del tramo módulo el tamaño del rotor
+    int rotacionInicial;     ///< Rotación acumulada antes del tramo
+    ListaDeCarga* carga;     ///< Segmento decodificado del tramo
+    long loads;              ///< Tramas LOAD del tramo
+    long maps;               ///< Tramas MAP del tramo
+    long invalidas;          ///< Líneas descartadas del tramo
+    long rotaciones;         ///< Rotaciones aplicadas en el tramo
+};
+
+/**
+ * @brief Recorre las líneas de un tramo aplicando una función a cada vista
+ * @param ini Inicio del tramo
+ * @param fin Fin del tramo
+ * @param f Función llamada con (puntero, longitud) de cada línea sin \\r\\n
+ */
+template <class F>
+inline void recorrerLineas(const char* ini, const char* fin, F& f) {
+    const char* p = ini;
+    while (p < fin) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(fin - p));
+        const char* finLinea = nl ? nl : fin;
+        size_t L = (size_t)(finLinea - p);
+        while (L > 0 && p[L-1] == '\r') --L;
+        f(p, L);
+        p = finLinea + 1;
+    }
+}
+
+/**
+ * @brief Primera pasada: rotación neta de un tramo
+ */
+struct SumaRotaciones {
+    int tam;                 ///< Tamaño del rotor
+    int neta;                ///< Rotación neta acumulada (0..tam-1)
+    Trama t;                 ///< Trama reutilizable
+    void operator()(const char* p, size_t len) {
+        if (analizarTrama(p, len, t) != TRAMA_OK || t.tipo != TRAMA_MAP) return;
+        int d = t.desplazamiento % tam;
+        if (d < 0) d += tam;
+        neta += d;
+        if (neta >= tam) neta -= tam;
+    }
+};
+
+/**
+ * @brief Segunda pasada: decodifica un tramo con su rotación inicial
+ */
+struct DecodificaTramo {
+    Decodificador* deco;     ///< Decodificador del tramo
+    Trama t;                 ///< Trama reutilizable
+    void operator()(const char* p, size_t len) {
+        if (analizarTrama(p, len, t) == TRAMA_OK) deco->procesar(t);
+        else deco->registrarInvalida();
+    }
+};
+
+/**
+ * @brief Calcula la rotación neta de un tramo (ejecutada por un hilo)
+ * @param tramo Tramo a recorrer
+ * @param tam Tamaño del rotor
+ */
+inline void calcularRotacionTramo(TramoCaptura* tramo, int tam) {
+    SumaRotaciones suma;
+    suma.tam = tam;
+    suma.neta = 0;
+    recorrerLineas(tramo->ini, tramo->fin, suma);
+    tramo->rotacionNeta = suma.neta;
+}
+
+/**
+ * @brief Decodifica un tramo en su propia lista (ejecutada por un hilo)
+ * @param tramo Tramo con rotacionInicial ya calculada
+ */
+inline void decodificarTramo(TramoCaptura* tramo) {
+    RotorActivo rotor;
+    rotor.fijarVerbosidad(VERB_SILENCIO);
+    rotor.fijarOffset(tramo->rotacionInicial);
+    tramo->carga->fijarVerbosidad(VERB_SILENCIO);
+
+    Decodificador deco(tramo->carga, &rotor, true);
+    DecodificaTramo paso;
+    paso.deco = &deco;
+    recorrerLineas(tramo->ini, tramo->fin, paso);
+    deco.finalizar();
+    tramo->loads = deco.getLoads();
+    tramo->maps = deco.getMaps();
+    tramo->invalidas = deco.getInvalidas();
+    tramo->rotaciones = deco.getRotaciones();
+}
+
+/**
+ * @brief Decodifica una captura completa en memoria usando varios hilos
+ * @param datos Inicio de la captura (p. ej. un archivo proyectado con mmap)
+ * @param tam Tamaño de la captura en bytes
+ * @param hilos Número de hilos (se reduce si la captura es pequeña)
+ * @param destino Lista donde se deja el mensaje completo, en orden
+ * @param rotor Rotor cuya posición inicial se respeta; queda en la posición final
+ * @param loads Recibe el total de tramas LOAD
+ * @param maps Recibe el total de tramas MAP
+ * @param invalidas Recibe el total de líneas descartadas
+ * @param rotaciones Recibe el total de rotaciones aplicadas
+ * @details Los tramos se cortan siempre después de un '\\n', de modo que
+ * ninguna línea queda partida entre dos hilos.
+ */
+inline void decodificarParalelo(const char* datos, size_t tam, int hilos,
+                                ListaDeCarga& destino, RotorActivo& rotor,
+                                long& loads, long& maps, long& invalidas,
+                                long& rotaciones) {
+    const size_t MIN_POR_HILO = 64 * 1024;
+    if (hilos < 1) hilos = 1;
+    if ((size_t)hilos > tam / MIN_POR_HILO + 1) hilos = (int)(tam / MIN_POR_HILO + 1);
+
+    // Cortar en tramos alineados a inicio de línea
+    TramoCaptura* tramos = new TramoCaptura[hilos];
+    const char* fin = datos + tam;
+    const char* ini = datos;
+    for (int i = 0; i < hilos; ++i) {
+        const char* corte = (i == hilos - 1) ? fin : datos + (tam / (size_t)hilos) * (size_t)(i + 1);
+        if (corte < ini) corte = ini;
+        if (corte < fin) {
+            const char* nl = (const char*)memchr(corte, '\n', (size_t)(fin - corte));
+            corte = nl ? nl + 1 : fin;
+        }
+        tramos[i].ini = ini;
+        tramos[i].fin = corte;
+        tramos[i].rotacionNeta = 0;
+        tramos[i].rotacionInicial = 0;
+        tramos[i].carga = new ListaDeCarga(destino.usaArena());
+        tramos[i].loads = tramos[i].maps = tramos[i].invalidas = 0;
+        tramos[i].rotaciones = 0;
+        ini = corte;
+    }
+
+    // Paso 1: rotación neta de cada tramo
+    const int tamRotor = rotor.getTamano();
+    std::thread* trabajadores = new std::thread[hilos];
+    for (int i = 0; i < hilos; ++i)
+        trabajadores[i] = std::thread(calcularRotacionTramo, &tramos[i], tamRotor);
+    for (int i = 0; i < hilos; ++i) trabajadores[i].join();
+
+    // Paso 2: prefijo exclusivo de rotaciones
+    int acumulada = rotor.getOffset();
+    for (int i = 0; i < hilos; ++i) {
+        tramos[i].rotacionInicial = acumulada;
+        acumulada = (acumulada + tramos[i].rotacionNeta) % tamRotor;
+    }
+
+    // Paso 3: decodificar cada tramo de forma independiente
+    for (int i = 0; i < hilos; ++i)
+        trabajadores[i] = std::thread(decodificarTramo, &tramos[i]);
+    for (int i = 0; i < hilos; ++i) trabajadores[i].join();
+
+    // Empalmar los segmentos en orden
+    loads = maps = invalidas = rotaciones = 0;
+    for (int i = 0; i < hilos; ++i) {
+        destino.concatenar(*tramos[i].carga);
+        loads += tramos[i].loads;
+        maps += tramos[i].maps;
+        invalidas += tramos[i].invalidas;
+        rotaciones += tramos[i].rotaciones;
+        delete tramos[i].carga;
+    }
+    rotor.fijarOffset(acumulada);
+
+    delete[] trabajadores;
+    delete[] tramos;
+}
+
+#endif // PRT7_PARALELO_H
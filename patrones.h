@@ -0,0 +1,270 @@
+/**
+ * @file patrones.h
+ * @brief Detección incremental de palabras clave en el mensaje (--alert)
+ *
+ * @details
+ * Autómata de Aho-Corasick alimentado por ListaDeCarga con cada fragmento
+ * decodificado: las coincidencias se detectan mientras llegan las tramas,
+ * sin volver a recorrer la lista ni esperar al mensaje final. El autómata
+ * se compila a una tabla de transición completa (256 entradas por estado),
+ * así que cada carácter cuesta una sola consulta más el informe de las
+ * coincidencias que terminan en él.
+ */
+
+#ifndef PRT7_PATRONES_H
+#define PRT7_PATRONES_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+/**************************************************************************
+ * @class BuscadorPatrones
+ * @brief Autómata de Aho-Corasick sobre los fragmentos decodificados
+ *
+ * @details
+ * Los patrones se agregan con agregar() y se compilan con compilar(); a
+ * partir de ahí alimentar() avanza el autómata. Cada estado guarda el
+ * patrón que termina en él (o -1) y el enlace de salida: el sufijo propio
+ * más largo que también es un patrón, para informar los patrones que son
+ * sufijo de otros ("SOS" dentro de "MAYSOS"). Cada coincidencia se escribe
+ * en stderr en el momento en que llega su último carácter.
+ **************************************************************************/
+class BuscadorPatrones {
+private:
+    static const int SIMBOLOS = 256;     ///< Transiciones por estado
+
+    int* transicion;         ///< SIMBOLOS entradas por estado (-1 = sin arista antes de compilar)
+    int* fallo;              ///< Estado del sufijo propio más largo que está en el trie
+    int* patronDe;           ///< Patrón que termina en cada estado (-1 = ninguno)
+    int* enlaceSalida;       ///< Estado con patrón alcanzable por fallos (-1 = ninguno)
+    int estados;             ///< Estados en uso (el 0 es la raíz)
+    int capacidadEstados;    ///< Estados reservados
+    char* texto;             ///< Patrones concatenados, cada uno terminado en '\0'
+    size_t enTexto;          ///< Bytes usados de texto
+    size_t capacidadTexto;   ///< Bytes reservados de texto
+    size_t* inicioPatron;    ///< Desplazamiento de cada patrón en texto
+    size_t* largoPatron;     ///< Longitud de cada patrón
+    long* coincidencias;     ///< Apariciones de cada patrón
+    int patrones;            ///< Patrones distintos agregados
+    int capacidadPatrones;   ///< Patrones reservados
+    int estado;              ///< Estado actual del autómata
+    bool compilado;          ///< compilar() ya construyó la tabla completa
+    long totalCoincidencias; ///< Suma de coincidencias
+
+    /**
+     * @brief Duplica un arreglo conservando los primeros usados elementos
+     * @param viejo Arreglo actual (se libera)
+     * @param usados Elementos a copiar
+     * @param nueva Tamaño del arreglo nuevo
+     * @return Arreglo nuevo
+     */
+    template <class T>
+    static T* crecer(T* viejo, size_t usados, size_t nueva) {
+        T* n = new T[nueva];
+        for (size_t i = 0; i < usados; ++i) n[i] = viejo[i];
+        delete[] viejo;
+        return n;
+    }
+
+    /**
+     * @brief Crea un estado sin aristas
+     * @return Índice del estado nuevo
+     */
+    int nuevoEstado() {
+        if (estados == capacidadEstados) {
+            int nueva = 2 * capacidadEstados;
+            transicion = crecer(transicion, (size_t)estados * SIMBOLOS, (size_t)nueva * SIMBOLOS);
+            fallo = crecer(fallo, (size_t)estados, (size_t)nueva);
+            patronDe = crecer(patronDe, (size_t)estados, (size_t)nueva);
+            enlaceSalida = crecer(enlaceSalida, (size_t)estados, (size_t)nueva);
+            capacidadEstados = nueva;
+        }
+        int s = estados++;
+        for (int c = 0; c < SIMBOLOS; ++c) transicion[(size_t)s * SIMBOLOS + c] = -1;
+        fallo[s] = 0;
+        patronDe[s] = -1;
+        enlaceSalida[s] = -1;
+        return s;
+    }
+
+    /**
+     * @brief Informa las coincidencias que terminan en el estado actual
+     * @param pos Índice del fragmento que completó la coincidencia
+     */
+    void informar(long pos) {
+        int s = patronDe[estado] >= 0 ? estado : enlaceSalida[estado];
+        for (; s >= 0; s = enlaceSalida[s]) {
+            int p = patronDe[s];
+            ++coincidencias[p];
+            ++totalCoincidencias;
+            long desde = pos + 1 - (long)largoPatron[p];
+            fprintf(stderr, "ALERTA: \"%s\" en los fragmentos %ld-%ld\n",
+                    texto + inicioPatron[p], desde, pos);
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor - autómata con solo la raíz y sin patrones
+     */
+    BuscadorPatrones()
+        : transicion(new int[16 * SIMBOLOS]), fallo(new int[16]), patronDe(new int[16]),
+          enlaceSalida(new int[16]), estados(0), capacidadEstados(16),
+          texto(new char[256]), enTexto(0), capacidadTexto(256),
+          inicioPatron(new size_t[8]), largoPatron(new size_t[8]), coincidencias(new long[8]),
+          patrones(0), capacidadPatrones(8), estado(0), compilado(false), totalCoincidencias(0) {
+        nuevoEstado();
+    }
+
+    /**
+     * @brief Destructor
+     */
+    ~BuscadorPatrones() {
+        delete[] transicion;
+        delete[] fallo;
+        delete[] patronDe;
+        delete[] enlaceSalida;
+        delete[] texto;
+        delete[] inicioPatron;
+        delete[] largoPatron;
+        delete[] coincidencias;
+    }
+
+    /**
+     * @brief Agrega un patrón al trie
+     * @param p Patrón (bytes tal como salen del rotor)
+     * @param largo Longitud del patrón
+     * @return false si está vacío, repetido o el autómata ya se compiló
+     */
+    bool agregar(const char* p, size_t largo) {
+        if (compilado || largo == 0) return false;
+        int s = 0;
+        for (size_t i = 0; i < largo; ++i) {
+            size_t k = (size_t)s * SIMBOLOS + (unsigned char)p[i];
+            if (transicion[k] < 0) {
+                int t = nuevoEstado();
+                transicion[(size_t)s * SIMBOLOS + (unsigned char)p[i]] = t;
+                s = t;
+            } else {
+                s = transicion[k];
+            }
+        }
+        if (patronDe[s] >= 0) return false;
+
+        if (patrones == capacidadPatrones) {
+            int nueva = 2 * capacidadPatrones;
+            inicioPatron = crecer(inicioPatron, (size_t)patrones, (size_t)nueva);
+            largoPatron = crecer(largoPatron, (size_t)patrones, (size_t)nueva);
+            coincidencias = crecer(coincidencias, (size_t)patrones, (size_t)nueva);
+            capacidadPatrones = nueva;
+        }
+        while (enTexto + largo + 1 > capacidadTexto) {
+            texto = crecer(texto, enTexto, 2 * capacidadTexto);
+            capacidadTexto *= 2;
+        }
+        memcpy(texto + enTexto, p, largo);
+        texto[enTexto + largo] = '\0';
+        inicioPatron[patrones] = enTexto;
+        largoPatron[patrones] = largo;
+        coincidencias[patrones] = 0;
+        enTexto += largo + 1;
+        patronDe[s] = patrones++;
+        return true;
+    }
+
+    /**
+     * @brief Calcula los fallos y completa la tabla de transición
+     * @post transicion[s][c] es el estado siguiente para cualquier s y c
+     * @details Recorre el trie en anchura: el fallo de un hijo es la
+     * transición del fallo del padre, que ya está completa.
+     */
+    void compilar() {
+        if (compilado) return;
+        int* cola = new int[estados];
+        int frente = 0, fondo = 0;
+        for (int c = 0; c < SIMBOLOS; ++c) {
+            int t = transicion[c];
+            if (t < 0) {
+                transicion[c] = 0;
+            } else {
+                fallo[t] = 0;
+                cola[fondo++] = t;
+            }
+        }
+        while (frente < fondo) {
+            int s = cola[frente++];
+            int* fila = transicion + (size_t)s * SIMBOLOS;
+            const int* filaFallo = transicion + (size_t)fallo[s] * SIMBOLOS;
+            for (int c = 0; c < SIMBOLOS; ++c) {
+                int t = fila[c];
+                if (t < 0) {
+                    fila[c] = filaFallo[c];
+                    continue;
+                }
+                int f = filaFallo[c];
+                fallo[t] = f;
+                enlaceSalida[t] = patronDe[f] >= 0 ? f : enlaceSalida[f];
+                cola[fondo++] = t;
+            }
+        }
+        delete[] cola;
+        compilado = true;
+        estado = 0;
+    }
+
+    /**
+     * @brief Avanza el autómata con un fragmento decodificado
+     * @param c Carácter
+     * @param pos Índice del fragmento en el mensaje (ListaDeCarga::getLongitud() antes de insertarlo)
+     * @pre compilar() ya se llamó
+     */
+    void alimentar(char c, long pos) {
+        estado = transicion[(size_t)estado * SIMBOLOS + (unsigned char)c];
+        if (patronDe[estado] >= 0 || enlaceSalida[estado] >= 0) informar(pos);
+    }
+
+    /**
+     * @brief Avanza el autómata con varios fragmentos seguidos
+     * @param datos Caracteres, en orden
+     * @param n Número de caracteres
+     * @param pos Índice del primero en el mensaje
+     */
+    void alimentar(const char* datos, size_t n, long pos) {
+        for (size_t i = 0; i < n; ++i) alimentar(datos[i], pos + (long)i);
+    }
+
+    /**
+     * @brief Número de patrones distintos
+     * @return Patrones agregados
+     */
+    int getPatrones() const { return patrones; }
+
+    /**
+     * @brief Texto de un patrón
+     * @param i Patrón (0..getPatrones()-1)
+     * @return Cadena terminada en '\0'
+     */
+    const char* getPatron(int i) const { return texto + inicioPatron[i]; }
+
+    /**
+     * @brief Apariciones de un patrón hasta ahora
+     * @param i Patrón (0..getPatrones()-1)
+     * @return Coincidencias informadas
+     */
+    long getCoincidencias(int i) const { return coincidencias[i]; }
+
+    /**
+     * @brief Apariciones de todos los patrones
+     * @return Suma de coincidencias
+     */
+    long getTotalCoincidencias() const { return totalCoincidencias; }
+
+    /**
+     * @brief Estados del autómata
+     * @return Estados incluida la raíz
+     */
+    int getEstados() const { return estados; }
+};
+
+#endif // PRT7_PATRONES_H
@@ -0,0 +1,176 @@
+/**
+ * @file prt7_c.cpp
+ * @brief Implementación de la API en C de libprt7 (ver prt7_c.h)
+ *
+ * @details
+ * Envuelve la ruta por valor del decodificador: analizarTrama() sobre
+ * vistas de línea, Decodificador con el plegado de MAP y los lotes de LOAD,
+ * RotorActivo y una ListaDeCarga de la que prt7_poll_decoded() retira los
+ * fragmentos ya entregados. Todo en VERB_SILENCIO: nada se escribe en
+ * consola.
+ */
+
+#include <cstring>
+#include <new>
+
+#include "prt7_c.h"
+#include "estructuras.h"
+#include "tramas.h"
+#include "decodificador.h"
+
+/**************************************************************************
+ * @struct prt7_decoder
+ * @brief Sesión de decodificación detrás del tipo opaco de la API
+ *
+ * @details
+ * Las líneas completas dentro de un mismo prt7_feed() se analizan en el
+ * lugar; solo la que queda partida entre dos llamadas se copia a linea, y
+ * se trunca a CAPACIDAD bytes como en las ranuras del pipeline.
+ **************************************************************************/
+struct prt7_decoder {
+    static const size_t CAPACIDAD = 256;  ///< Bytes de la línea partida
+
+    ListaDeCarga* carga;     ///< Fragmentos decodificados sin recoger
+    RotorActivo* rotor;      ///< Rotor de la sesión
+    Decodificador* deco;     ///< Bucle de decodificación
+    char linea[CAPACIDAD];   ///< Línea partida entre llamadas a prt7_feed()
+    size_t enLinea;          ///< Bytes válidos en linea
+    bool hayLinea;           ///< Hay una línea partida pendiente (puede estar vacía)
+
+    /**
+     * @brief Constructor - sin estructuras; ver crear()
+     */
+    prt7_decoder() : carga(nullptr), rotor(nullptr), deco(nullptr), enLinea(0), hayLinea(false) {}
+
+    /**
+     * @brief Destructor - libera las estructuras de la sesión
+     */
+    ~prt7_decoder() { liberar(); }
+
+    /**
+     * @brief Reserva las estructuras de una sesión nueva
+     * @return false si no hay memoria
+     */
+    bool crear() {
+        carga = new (std::nothrow) ListaDeCarga();
+        rotor = new (std::nothrow) RotorActivo();
+        if (!carga || !rotor) return false;
+        carga->fijarVerbosidad(VERB_SILENCIO);
+        rotor->fijarVerbosidad(VERB_SILENCIO);
+        deco = new (std::nothrow) Decodificador(carga, rotor, true);
+        enLinea = 0;
+        hayLinea = false;
+        return deco != nullptr;
+    }
+
+    /**
+     * @brief Libera las estructuras de la sesión
+     */
+    void liberar() {
+        delete deco;
+        delete rotor;
+        delete carga;
+        deco = nullptr;
+        rotor = nullptr;
+        carga = nullptr;
+    }
+
+    /**
+     * @brief Analiza y aplica una línea completa
+     * @param p Inicio de la línea (sin '\n')
+     * @param len Longitud de la línea
+     */
+    void procesarLinea(const char* p, size_t len) {
+        while (len > 0 && p[len - 1] == '\r') --len;
+        Trama t;
+        if (analizarTrama(p, len, t) == TRAMA_OK) deco->procesar(t);
+        else deco->registrarInvalida();
+    }
+
+    /**
+     * @brief Añade bytes a la línea partida, truncándola si no cabe
+     * @param p Bytes a añadir
+     * @param len Número de bytes
+     */
+    void acumular(const char* p, size_t len) {
+        size_t k = CAPACIDAD - enLinea;
+        if (k > len) k = len;
+        memcpy(linea + enLinea, p, k);
+        enLinea += k;
+        hayLinea = true;
+    }
+};
+
+extern "C" {
+
+prt7_decoder* prt7_create(void) {
+    prt7_decoder* d = new (std::nothrow) prt7_decoder();
+    if (d && !d->crear()) {
+        delete d;
+        return nullptr;
+    }
+    return d;
+}
+
+void prt7_destroy(prt7_decoder* d) {
+    delete d;
+}
+
+long prt7_feed(prt7_decoder* d, const char* bytes, size_t len) {
+    if (!d || !d->deco || (!bytes && len > 0)) return PRT7_ERR_ARGUMENT;
+    const char* p = bytes;
+    const char* fin = bytes + len;
+    long lineas = 0;
+    while (p < fin) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(fin - p));
+        if (!nl) {
+            d->acumular(p, (size_t)(fin - p));
+            break;
+        }
+        if (d->hayLinea) {
+            d->acumular(p, (size_t)(nl - p));
+            d->procesarLinea(d->linea, d->enLinea);
+            d->enLinea = 0;
+            d->hayLinea = false;
+        } else {
+            d->procesarLinea(p, (size_t)(nl - p));
+        }
+        ++lineas;
+        p = nl + 1;
+    }
+    return lineas;
+}
+
+long prt7_finish(prt7_decoder* d) {
+    if (!d || !d->deco) return PRT7_ERR_ARGUMENT;
+    if (!d->hayLinea) return 0;
+    d->procesarLinea(d->linea, d->enLinea);
+    d->enLinea = 0;
+    d->hayLinea = false;
+    return 1;
+}
+
+size_t prt7_poll_decoded(prt7_decoder* d, char* buf, size_t cap) {
+    if (!d || !d->deco || !buf) return 0;
+    d->deco->vaciarLote();
+    return d->carga->extraer(buf, cap);
+}
+
+void prt7_reset(prt7_decoder* d) {
+    if (!d) return;
+    d->liberar();
+    d->crear();
+}
+
+int prt7_get_stats(prt7_decoder* d, prt7_stats* s) {
+    if (!d || !s || !d->deco) return PRT7_ERR_ARGUMENT;
+    d->deco->vaciarLote();
+    s->loads = d->deco->getLoads();
+    s->maps = d->deco->getMaps();
+    s->invalid = d->deco->getInvalidas();
+    s->decoded = d->carga->getLongitud();
+    s->pending = d->carga->getRetenidos();
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,120 @@
+/**
+ * @file prt7_c.h
+ * @brief API en C de libprt7: decodificación PRT-7 dentro del proceso
+ *
+ * @details
+ * Interfaz de empuje para incrustar el decodificador en otro programa sin
+ * lanzar prtdcd ni interpretar su salida: el llamador entrega bytes del
+ * protocolo de texto con prt7_feed() en trozos de cualquier tamaño y
+ * recoge el mensaje decodificado con prt7_poll_decoded(). La biblioteca no
+ * escribe nada en consola.
+ *
+ * Cada prt7_decoder es independiente; no es seguro usar el mismo desde
+ * varios hilos a la vez.
+ *
+ * @code
+ * prt7_decoder* d = prt7_create();
+ * prt7_feed(d, datos, largo);
+ * char buf[4096];
+ * size_t n;
+ * while ((n = prt7_poll_decoded(d, buf, sizeof(buf))) > 0) procesar(buf, n);
+ * prt7_destroy(d);
+ * @endcode
+ */
+
+#ifndef PRT7_C_H
+#define PRT7_C_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Estado opaco de una sesión de decodificación
+ */
+typedef struct prt7_decoder prt7_decoder;
+
+/**
+ * @brief Contadores de una sesión
+ */
+typedef struct prt7_stats {
+    long long loads;         /**< Tramas LOAD procesadas */
+    long long maps;          /**< Tramas MAP procesadas */
+    long long invalid;       /**< Líneas descartadas por el parser */
+    long long decoded;       /**< Fragmentos decodificados desde el último reset */
+    long long pending;       /**< Fragmentos decodificados aún sin recoger */
+} prt7_stats;
+
+/**
+ * @brief Códigos de error de la API
+ */
+enum {
+    PRT7_ERR_ARGUMENT = -1   /**< Puntero nulo o longitud inválida */
+};
+
+/**
+ * @brief Crea una sesión con el rotor en su posición inicial
+ * @return Sesión nueva, o NULL si no hay memoria
+ */
+prt7_decoder* prt7_create(void);
+
+/**
+ * @brief Libera una sesión (NULL se ignora)
+ * @param d Sesión creada con prt7_create()
+ */
+void prt7_destroy(prt7_decoder* d);
+
+/**
+ * @brief Entrega bytes del protocolo de texto ("L,X" / "M,N" por línea)
+ * @param d Sesión
+ * @param bytes Datos recibidos; las líneas pueden partirse entre llamadas
+ * @param len Número de bytes
+ * @return Líneas completas procesadas, o PRT7_ERR_ARGUMENT
+ * @details La última línea sin '\n' queda pendiente hasta la siguiente
+ * llamada o hasta prt7_finish().
+ */
+long prt7_feed(prt7_decoder* d, const char* bytes, size_t len);
+
+/**
+ * @brief Procesa la línea pendiente sin '\n' final, si la hay
+ * @param d Sesión
+ * @return 1 si había una línea pendiente, 0 si no, o PRT7_ERR_ARGUMENT
+ */
+long prt7_finish(prt7_decoder* d);
+
+/**
+ * @brief Recoge fragmentos decodificados en orden de llegada
+ * @param d Sesión
+ * @param buf Destino
+ * @param cap Bytes disponibles en buf
+ * @return Bytes copiados (0 si no hay nada pendiente o los argumentos son inválidos)
+ * @details Los fragmentos recogidos se retiran de la sesión y su memoria
+ * se reutiliza para los siguientes.
+ */
+size_t prt7_poll_decoded(prt7_decoder* d, char* buf, size_t cap);
+
+/**
+ * @brief Vuelve la sesión al estado de prt7_create()
+ * @param d Sesión
+ * @details Descarta la línea pendiente, los fragmentos sin recoger y los
+ * contadores; el rotor vuelve a la posición inicial. Si no hay memoria
+ * para la sesión nueva, las demás funciones devuelven PRT7_ERR_ARGUMENT
+ * hasta un prt7_reset() que sí lo logre.
+ */
+void prt7_reset(prt7_decoder* d);
+
+/**
+ * @brief Consulta los contadores de una sesión
+ * @param d Sesión
+ * @param s Recibe los contadores
+ * @return 0, o PRT7_ERR_ARGUMENT
+ */
+int prt7_get_stats(prt7_decoder* d, prt7_stats* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRT7_C_H */
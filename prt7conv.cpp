@@ -0,0 +1,129 @@
+/**
+ * @file prt7conv.cpp
+ * @brief Conversor de capturas PRT-7 entre el formato de texto y el binario
+ *
+ * @details
+ * Convierte capturas del estilo de simulacion.txt ("L,X" / "M,N" por línea)
+ * al formato binario de bloques de binario.h, y viceversa. Las líneas que
+ * el parser rechaza no se trasladan y se informan al final.
+ *
+ * Las líneas "M,<rotor>,N" con N numérico se leen como las de prtdcd
+ * --rotors y pasan al registro MAP con rotor; el binario resultante solo
+ * se decodifica igual con --rotors, y el conversor lo avisa.
+ *
+ * @section usage Uso
+ * @code
+ * ./prt7conv --a-binario simulacion.txt simulacion.bin
+ * ./prt7conv --a-texto simulacion.bin simulacion2.txt
+ * @endcode
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+#include "tramas.h"
+#include "binario.h"
+#include "serial_reader.h"
+
+using std::cout;
+using std::endl;
+
+/**
+ * @brief Escribe una trama en notación de texto
+ * @param t Trama LOAD o MAP
+ * @param f Archivo de salida
+ */
+static void escribirTexto(const Trama& t, FILE* f) {
+    if (t.tipo == TRAMA_LOAD) {
+        if (t.fragmento == ' ') fputs("L,Space\n", f);
+        else fprintf(f, "L,%c\n", t.fragmento);
+    } else if (t.tipo == TRAMA_MAP && t.rotor != 0) {
+        fprintf(f, "M,%d,%d\n", t.rotor, t.desplazamiento);
+    } else if (t.tipo == TRAMA_MAP) {
+        fprintf(f, "M,%d\n", t.desplazamiento);
+    }
+}
+
+/**************************************************************************
+ * @brief Punto de entrada del conversor
+ * @param argc Número de argumentos
+ * @param argv Array de argumentos
+ * @return 0 si éxito, 1 si error
+ *
+ * @section args Argumentos
+ * - --a-binario <entrada> <salida> : Texto a bloques binarios
+ * - --a-texto <entrada> <salida> : Bloques binarios a texto
+ **************************************************************************/
+int main(int argc, char** argv) {
+    if (argc != 4 || (strcmp(argv[1], "--a-binario") != 0 && strcmp(argv[1], "--a-texto") != 0)) {
+        cout << "Uso: " << argv[0] << " --a-binario|--a-texto <entrada> <salida>" << endl;
+        return 1;
+    }
+    const bool aBinario = (strcmp(argv[1], "--a-binario") == 0);
+
+    SerialReader reader;
+    reader.fijarVerbosidad(VERB_SILENCIO);
+    if (!reader.abrir(argv[2])) return 1;
+    if (reader.esFormatoBinario() == aBinario) {
+        cout << "La entrada '" << argv[2] << "' ya está en formato "
+             << (aBinario ? "binario" : "de texto") << "." << endl;
+        return 1;
+    }
+
+    FILE* salida = fopen(argv[3], aBinario ? "wb" : "w");
+    if (!salida) {
+        cout << "Error abriendo '" << argv[3] << "': " << strerror(errno) << endl;
+        return 1;
+    }
+
+    long tramas = 0, descartadas = 0, bytesEntrada = 0, dirigidas = 0;
+    Trama t;
+    if (aBinario) {
+        EscritorBinario escritor(salida);
+        const char* vista;
+        size_t largo;
+        while (reader.leerVista(vista, largo)) {
+            bytesEntrada += (long)largo + 1;
+            // Como prtdcd --rotors: el formato binario conserva el rotor de "M,<rotor>,N"
+            if (analizarTrama(vista, largo, t, true) != TRAMA_OK) {
+                ++descartadas;
+                continue;
+            }
+            if (t.tipo == TRAMA_MAP && t.rotor != 0) ++dirigidas;
+            escritor.escribir(t);
+            ++tramas;
+        }
+        escritor.vaciar();
+        cout << tramas << " tramas: " << bytesEntrada << " bytes de texto -> "
+             << escritor.getBytes() << " bytes en " << escritor.getBloques() << " bloques";
+        if (escritor.getBytes() > 0)
+            cout << " (" << (double)bytesEntrada / (double)escritor.getBytes() << "x)";
+        cout << endl;
+        if (dirigidas > 0)
+            cout << dirigidas << " tramas \"M,<rotor>,N\" guardadas para un banco de rotores: "
+                    "decodificar la salida con prtdcd --rotors." << endl;
+    } else {
+        const unsigned char* bloque;
+        size_t largo;
+        while (reader.leerBloque(bloque, largo)) {
+            LectorBloque registros(bloque, largo);
+            while (registros.siguiente(t)) {
+                if (t.tipo == TRAMA_INVALIDA) {
+                    ++descartadas;
+                    continue;
+                }
+                escribirTexto(t, salida);
+                ++tramas;
+            }
+        }
+        descartadas += reader.getBloquesDescartados();
+        cout << tramas << " tramas convertidas a texto" << endl;
+    }
+    if (descartadas > 0)
+        cout << "Descartadas: " << descartadas << endl;
+
+    bool ok = (fclose(salida) == 0);
+    if (!ok) cout << "Error escribiendo '" << argv[3] << "'" << endl;
+    return ok ? 0 : 1;
+}
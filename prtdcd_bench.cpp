@@ -0,0 +1,472 @@
+/**
+ * @file prtdcd_bench.cpp
+ * @brief Banco de pruebas de rendimiento del decodificador PRT-7
+ *
+ * @details
+ * Genera en memoria un flujo sintético de tramas LOAD/MAP y mide por
+ * separado el parser, los rotores, la ListaDeCarga y el flujo completo,
+ * comparando las estructuras del caso de estudio (lista circular, un nodo
+ * por new) con los motores optimizados sobre las mismas entradas.
+ *
+ * @section usage Uso
+ * @code
+ * ./prtdcd_bench --frames 1000000 --map-ratio 0.1 --rot-max 25 --rot-dist uniform
+ * @endcode
+ */
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+#include "estructuras.h"
+#include "tramas.h"
+#include "decodificador.h"
+#include "lote.h"
+
+using std::cout;
+using std::endl;
+
+/**************************************************************************
+ * Utilidades de medición
+ **************************************************************************/
+
+/**
+ * @brief Tiempo monótono actual en nanosegundos
+ * @return Nanosegundos desde un origen arbitrario
+ */
+static double ahoraNs() {
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+#else
+    return (double)clock() * (1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+/**
+ * @brief Pico de memoria residente del proceso
+ * @return KiB de RSS máximo (0 si no está disponible)
+ */
+static long picoRssKb() {
+#ifdef __linux__
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) return ru.ru_maxrss;
+#endif
+    return 0;
+}
+
+/**
+ * @brief Imprime una fila de resultados
+ * @param nombre Nombre de la etapa medida
+ * @param tramas Número de tramas procesadas
+ * @param ns Tiempo total en nanosegundos
+ * @param control Valor de control (evita que el compilador elimine el trabajo)
+ */
+static void reportar(const char* nombre, long tramas, double ns, unsigned long control) {
+    double porTrama = (tramas > 0 ? ns / tramas : 0.0);
+    double porSeg = (ns > 0 ? tramas * 1e9 / ns : 0.0);
+    char fila[160];
+    snprintf(fila, sizeof(fila), "%-34s %12.0f tramas/s %9.2f ns/trama  RSS pico %7ld KiB  [%lx]",
+             nombre, porSeg, porTrama, picoRssKb(), control);
+    cout << fila << '\n';
+}
+
+/**************************************************************************
+ * Generador sintético
+ **************************************************************************/
+
+/**
+ * @enum DistRotacion
+ * @brief Distribución de los desplazamientos de las tramas MAP
+ */
+enum DistRotacion {
+    DIST_UNIFORME,       ///< Uniforme en [-max, max]
+    DIST_PEQUENA,        ///< Mayormente ±1..3, como un emisor que avanza poco a poco
+    DIST_GRANDE          ///< Rotaciones grandes (varias vueltas completas)
+};
+
+/**
+ * @brief Generador pseudoaleatorio xorshift64 (reproducible con la semilla)
+ * @param estado Estado del generador
+ * @return Siguiente valor
+ */
+static unsigned long long siguienteAleatorio(unsigned long long& estado) {
+    estado ^= estado << 13;
+    estado ^= estado >> 7;
+    estado ^= estado << 17;
+    return estado;
+}
+
+/**
+ * @brief Genera un flujo de texto "L,X"/"M,N" en memoria
+ * @param tramas Número de tramas a generar
+ * @param proporcionMap Fracción de tramas MAP (0..1)
+ * @param rotMax Desplazamiento máximo de las tramas MAP
+ * @param dist Distribución de los desplazamientos
+ * @param semilla Semilla del generador
+ * @param largo Recibe la longitud del texto generado
+ * @return Buffer con el texto (liberar con delete[])
+ */
+static char* generarFlujo(long tramas, double proporcionMap, int rotMax, DistRotacion dist,
+                          unsigned long long semilla, size_t& largo) {
+    char* texto = new char[(size_t)tramas * 16 + 1];
+    char* p = texto;
+    unsigned long long estado = semilla ? semilla : 0x9E3779B97F4A7C15ULL;
+    const unsigned long long umbralMap = (unsigned long long)(proporcionMap * 1000000.0);
+    if (rotMax < 1) rotMax = 1;
+
+    for (long i = 0; i < tramas; ++i) {
+        unsigned long long r = siguienteAleatorio(estado);
+        if (r % 1000000ULL < umbralMap) {
+            int n = 0;
+            unsigned long long a = siguienteAleatorio(estado);
+            switch (dist) {
+            case DIST_PEQUENA:
+                n = 1 + (int)(a % 3);
+                break;
+            case DIST_GRANDE:
+                n = 26 * (1 + (int)(a % 8)) + (int)((a >> 8) % 26);
+                break;
+            default:
+                n = (int)(a % (unsigned long long)rotMax) + 1;
+                break;
+            }
+            if ((a >> 32) & 1) n = -n;
+            p += sprintf(p, "M,%d\n", n);
+        } else {
+            unsigned long long a = siguienteAleatorio(estado) % 27;
+            if (a == 26) {
+                memcpy(p, "L,Space\n", 8);
+                p += 8;
+            } else {
+                p[0] = 'L';
+                p[1] = ',';
+                p[2] = char('A' + a);
+                p[3] = '\n';
+                p += 4;
+            }
+        }
+    }
+    *p = '\0';
+    largo = (size_t)(p - texto);
+    return texto;
+}
+
+/**************************************************************************
+ * Etapas medidas
+ **************************************************************************/
+
+/**
+ * @brief Recorre las líneas del texto aplicando una función por línea
+ * @param texto Flujo generado
+ * @param largo Longitud del flujo
+ * @param f Función a aplicar a cada vista de línea
+ */
+template <class F>
+static void porLinea(const char* texto, size_t largo, F& f) {
+    const char* p = texto;
+    const char* fin = texto + largo;
+    while (p < fin) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(fin - p));
+        const char* finLinea = nl ? nl : fin;
+        f(p, (size_t)(finLinea - p));
+        p = finLinea + 1;
+    }
+}
+
+/**
+ * @brief Parser por valor: analizarTrama() sobre la vista de cada línea
+ */
+struct ParserVista {
+    Trama* salida;       ///< Arreglo donde se guardan las tramas parseadas
+    long n;              ///< Tramas parseadas
+    void operator()(const char* p, size_t len) {
+        if (analizarTrama(p, len, salida[n]) == TRAMA_OK) ++n;
+    }
+};
+
+/**
+ * @brief Parser polimórfico: copia terminada en '\\0' + parseLinea() + delete
+ */
+struct ParserPoo {
+    long n;              ///< Tramas válidas
+    unsigned long control; ///< Valor de control
+    void operator()(const char* p, size_t len) {
+        char linea[128];
+        size_t L = (len < sizeof(linea) ? len : sizeof(linea) - 1);
+        memcpy(linea, p, L);
+        linea[L] = '\0';
+        TramaBase* t = parseLinea(linea);
+        if (t) {
+            ++n;
+            control += (unsigned long)(size_t)t & 0xff;
+            delete t;
+        }
+    }
+};
+
+/**
+ * @brief Aplica las tramas a un rotor sin almacenar el resultado
+ * @param rotor Rotor a medir
+ * @param tramas Tramas ya parseadas
+ * @param n Número de tramas
+ * @return Suma de control de los caracteres decodificados
+ */
+template <class Rotor>
+static unsigned long medirRotor(Rotor& rotor, const Trama* tramas, long n) {
+    unsigned long control = 0;
+    for (long i = 0; i < n; ++i) {
+        if (tramas[i].tipo == TRAMA_MAP) rotor.rotar(tramas[i].desplazamiento);
+        else control = control * 31 + (unsigned char)rotor.getMapeo(tramas[i].fragmento);
+    }
+    return control;
+}
+
+/**
+ * @brief Aplica las tramas a un banco de rotores sin almacenar el resultado
+ * @param banco Banco a medir
+ * @param tramas Tramas ya parseadas (las MAP giran los rotores por turnos)
+ * @param n Número de tramas
+ * @return Suma de control de los caracteres decodificados
+ */
+static unsigned long medirBanco(BancoRotores& banco, const Trama* tramas, long n) {
+    unsigned long control = 0;
+    int siguiente = 0;
+    for (long i = 0; i < n; ++i) {
+        if (tramas[i].tipo == TRAMA_MAP) {
+            banco.rotar(siguiente, tramas[i].desplazamiento);
+            if (++siguiente == banco.getRotores()) siguiente = 0;
+        } else {
+            control = control * 31 + (unsigned char)banco.getMapeo(tramas[i].fragmento);
+            banco.avanzar();
+        }
+    }
+    return control;
+}
+
+/**
+ * @brief Inserta caracteres en una ListaDeCarga y la recorre completa
+ * @param carga Lista a llenar
+ * @param datos Caracteres a insertar
+ * @param n Número de caracteres
+ * @return Suma de control del recorrido
+ */
+static unsigned long medirLista(ListaDeCarga& carga, const char* datos, long n) {
+    for (long i = 0; i < n; ++i) carga.insertarAlFinal(datos[i]);
+    unsigned long control = 0;
+    for (const NodoCarga* cur = carga.primero(); cur; cur = cur->next)
+        control = control * 31 + (unsigned char)cur->dato;
+    return control;
+}
+
+/**
+ * @brief Flujo completo: parser por valor, rotor y lista de carga
+ * @param rotor Rotor a usar
+ * @param carga Lista de carga
+ * @param texto Flujo generado
+ * @param largo Longitud del flujo
+ * @return Número de tramas válidas
+ */
+template <class Rotor>
+static long medirFlujo(Rotor& rotor, ListaDeCarga& carga, const char* texto, size_t largo) {
+    struct Etapa {
+        Rotor* rotor;
+        ListaDeCarga* carga;
+        long n;
+        Trama t;
+        void operator()(const char* p, size_t len) {
+            if (analizarTrama(p, len, t) != TRAMA_OK) return;
+            ++n;
+            if (t.tipo == TRAMA_MAP) rotor->rotar(t.desplazamiento);
+            else carga->insertarAlFinal(rotor->getMapeo(t.fragmento));
+        }
+    } etapa;
+    etapa.rotor = &rotor;
+    etapa.carga = &carga;
+    etapa.n = 0;
+    porLinea(texto, largo, etapa);
+    return etapa.n;
+}
+
+/**************************************************************************
+ * @brief Punto de entrada del banco de pruebas
+ * @param argc Número de argumentos
+ * @param argv Array de argumentos
+ * @return 0 si éxito, 1 si error
+ *
+ * @section args Argumentos
+ * - --frames <N> : Número de tramas sintéticas (por defecto 1000000)
+ * - --map-ratio <R> : Fracción de tramas MAP (por defecto 0.1)
+ * - --rot-max <K> : Desplazamiento máximo en la distribución uniforme (por defecto 25)
+ * - --rot-dist <uniform|small|large> : Distribución de los desplazamientos
+ * - --seed <S> : Semilla del generador
+ **************************************************************************/
+int main(int argc, char** argv) {
+    long tramas = 1000000;
+    double proporcionMap = 0.1;
+    int rotMax = 25;
+    DistRotacion dist = DIST_UNIFORME;
+    unsigned long long semilla = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            tramas = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--map-ratio") == 0 && i + 1 < argc) {
+            proporcionMap = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rot-max") == 0 && i + 1 < argc) {
+            rotMax = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rot-dist") == 0 && i + 1 < argc) {
+            const char* d = argv[++i];
+            if (strcmp(d, "uniform") == 0) dist = DIST_UNIFORME;
+            else if (strcmp(d, "small") == 0) dist = DIST_PEQUENA;
+            else if (strcmp(d, "large") == 0) dist = DIST_GRANDE;
+            else {
+                cout << "Distribución desconocida: " << d << endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            semilla = strtoull(argv[++i], nullptr, 10);
+        } else {
+            cout << "Uso: " << argv[0] << " [--frames N] [--map-ratio R] [--rot-max K]"
+                 << " [--rot-dist uniform|small|large] [--seed S]" << endl;
+            return 1;
+        }
+    }
+    if (tramas < 1) tramas = 1;
+    if (proporcionMap < 0) proporcionMap = 0;
+    if (proporcionMap > 1) proporcionMap = 1;
+
+    size_t largo = 0;
+    char* texto = generarFlujo(tramas, proporcionMap, rotMax, dist, semilla, largo);
+    cout << "Flujo sintético: " << tramas << " tramas, " << largo << " bytes, MAP "
+         << proporcionMap << '\n' << '\n';
+
+    // Parser
+    Trama* parseadas = new Trama[tramas];
+    ParserVista pv;
+    pv.salida = parseadas;
+    pv.n = 0;
+    double t0 = ahoraNs();
+    porLinea(texto, largo, pv);
+    reportar("parser parsearTrama (vista)", pv.n, ahoraNs() - t0, (unsigned long)pv.n);
+
+    ParserPoo pp;
+    pp.n = 0;
+    pp.control = 0;
+    t0 = ahoraNs();
+    porLinea(texto, largo, pp);
+    reportar("parser parseLinea (new/delete)", pp.n, ahoraNs() - t0, pp.control);
+
+    // Rotores
+    {
+        RotorDeMapeo lista;
+        lista.fijarVerbosidad(VERB_SILENCIO);
+        t0 = ahoraNs();
+        unsigned long c = medirRotor(lista, parseadas, pv.n);
+        reportar("rotor RotorDeMapeo (lista)", pv.n, ahoraNs() - t0, c);
+
+        RotorTabla tabla;
+        tabla.fijarVerbosidad(VERB_SILENCIO);
+        t0 = ahoraNs();
+        c = medirRotor(tabla, parseadas, pv.n);
+        reportar("rotor RotorTabla", pv.n, ahoraNs() - t0, c);
+
+        RotorAlfabeto<AlfabetoAlfanumerico> extendido;
+        extendido.fijarVerbosidad(VERB_SILENCIO);
+        t0 = ahoraNs();
+        c = medirRotor(extendido, parseadas, pv.n);
+        reportar("rotor RotorAlfabeto (A-Z0-9)", pv.n, ahoraNs() - t0, c);
+
+        BancoRotores banco(3, PASO_NINGUNO);
+        banco.fijarVerbosidad(VERB_SILENCIO);
+        t0 = ahoraNs();
+        c = medirBanco(banco, parseadas, pv.n);
+        reportar("banco de 3 rotores", pv.n, ahoraNs() - t0, c);
+
+        BancoRotores odometro(3, PASO_ODOMETRO);
+        odometro.fijarVerbosidad(VERB_SILENCIO);
+        t0 = ahoraNs();
+        c = medirBanco(odometro, parseadas, pv.n);
+        reportar("banco de 3 rotores (odómetro)", pv.n, ahoraNs() - t0, c);
+    }
+
+    // Lista de carga (con los caracteres de las tramas LOAD)
+    char* datos = new char[pv.n > 0 ? pv.n : 1];
+    long nDatos = 0;
+    for (long i = 0; i < pv.n; ++i)
+        if (parseadas[i].tipo == TRAMA_LOAD) datos[nDatos++] = parseadas[i].fragmento;
+    {
+        ListaDeCarga individual(false);
+        t0 = ahoraNs();
+        unsigned long c = medirLista(individual, datos, nDatos);
+        reportar("ListaDeCarga (new por nodo)", nDatos, ahoraNs() - t0, c);
+    }
+    {
+        ListaDeCarga arena(true);
+        t0 = ahoraNs();
+        unsigned long c = medirLista(arena, datos, nDatos);
+        reportar("ListaDeCarga (arena)", nDatos, ahoraNs() - t0, c);
+    }
+
+    // Traducción de fragmentos: getMapeo() por byte frente al núcleo por lotes
+    {
+        RotorTabla rotor;
+        rotor.fijarVerbosidad(VERB_SILENCIO);
+        rotor.fijarOffset(7);
+        char* salida = new char[nDatos > 0 ? nDatos : 1];
+        t0 = ahoraNs();
+        for (long i = 0; i < nDatos; ++i) salida[i] = rotor.getMapeo(datos[i]);
+        reportar("getMapeo por fragmento", nDatos, ahoraNs() - t0, (unsigned char)salida[nDatos / 2]);
+
+        t0 = ahoraNs();
+        decodificarLote(datos, salida, (size_t)nDatos, rotor.getOffset());
+        reportar("decodificarLote", nDatos, ahoraNs() - t0, (unsigned char)salida[nDatos / 2]);
+        delete[] salida;
+    }
+
+    // Flujo completo
+    {
+        RotorDeMapeo rotor;
+        rotor.fijarVerbosidad(VERB_SILENCIO);
+        ListaDeCarga carga(false);
+        carga.fijarVerbosidad(VERB_SILENCIO);
+        t0 = ahoraNs();
+        long n = medirFlujo(rotor, carga, texto, largo);
+        reportar("flujo completo (curso)", n, ahoraNs() - t0, (unsigned long)carga.getLongitud());
+    }
+    {
+        RotorTabla rotor;
+        rotor.fijarVerbosidad(VERB_SILENCIO);
+        ListaDeCarga carga(true);
+        carga.fijarVerbosidad(VERB_SILENCIO);
+        t0 = ahoraNs();
+        long n = medirFlujo(rotor, carga, texto, largo);
+        reportar("flujo completo (optimizado)", n, ahoraNs() - t0, (unsigned long)carga.getLongitud());
+    }
+
+    for (int plegado = 0; plegado <= 1; ++plegado) {
+        RotorActivo rotor;
+        rotor.fijarVerbosidad(VERB_SILENCIO);
+        ListaDeCarga carga;
+        carga.fijarVerbosidad(VERB_SILENCIO);
+        Decodificador deco(&carga, &rotor, plegado != 0);
+        t0 = ahoraNs();
+        for (long i = 0; i < pv.n; ++i) deco.procesar(parseadas[i]);
+        deco.finalizar();
+        reportar(plegado ? "Decodificador (MAP plegados)" : "Decodificador (MAP directos)",
+                 pv.n, ahoraNs() - t0, (unsigned long)deco.getRotaciones());
+    }
+
+    delete[] datos;
+    delete[] parseadas;
+    delete[] texto;
+    cout.flush();
+    return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file punto_control.h
+ * @brief Puntos de control para reanudar sesiones largas (--checkpoint, --resume)
+ *
+ * @details
+ * Un punto de control son dos archivos con la misma base:
+ * - <base>.msg : el mensaje decodificado, escrito solo al final (modo
+ *   flujo de ListaDeCarga), nunca reescrito.
+ * - <base>.ckpt : una línea de texto con la posición del rotor, el número
+ *   de tramas consumidas, la posición en la entrada y la longitud válida
+ *   del .msg. Se reemplaza de forma atómica (archivo temporal + rename).
+ *
+ * Al reanudar, el .msg se recorta a la longitud registrada (los bytes
+ * escritos después del último punto se vuelven a decodificar), el rotor se
+ * coloca en su posición y la entrada continúa desde el byte registrado, sin
+ * recorrer el historial.
+ */
+
+#ifndef PRT7_PUNTO_CONTROL_H
+#define PRT7_PUNTO_CONTROL_H
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+/**
+ * @struct EstadoControl
+ * @brief Estado del decodificador guardado en <base>.ckpt
+ */
+struct EstadoControl {
+    int posicionRotor;       ///< Desplazamiento del rotor para el siguiente LOAD
+    long long secuencia;     ///< Tramas consumidas (LOAD + MAP + inválidas)
+    long long bytes;         ///< Posición en la entrada tras la última trama consumida
+    long longitud;           ///< Fragmentos válidos en <base>.msg
+    long loads;              ///< Tramas LOAD procesadas
+    long maps;               ///< Tramas MAP procesadas
+    long invalidas;          ///< Líneas o registros descartados
+    long rotaciones;         ///< Rotaciones aplicadas al rotor
+
+    /**
+     * @brief Constructor - estado de una sesión nueva
+     */
+    EstadoControl() : posicionRotor(0), secuencia(0), bytes(0), longitud(0),
+                      loads(0), maps(0), invalidas(0), rotaciones(0) {}
+};
+
+/**************************************************************************
+ * @class PuntoControl
+ * @brief Escribe y lee los archivos de punto de control de una sesión
+ *
+ * @details
+ * El llamador decide cuándo guardar (tocaGuardar() cada N líneas o
+ * bloques) y debe haber vaciado antes el mensaje en el .msg, de modo que
+ * el .ckpt nunca cuente fragmentos que no estén en disco.
+ **************************************************************************/
+class PuntoControl {
+private:
+    char* rutaEstado;        ///< <base>.ckpt
+    char* rutaTemporal;      ///< <base>.ckpt.tmp
+    char* rutaMensaje;       ///< <base>.msg
+    FILE* mensaje;           ///< <base>.msg abierto para añadir
+    long cadaN;              ///< Líneas o bloques entre puntos de control
+    long desdeUltimo;        ///< Líneas o bloques desde el último punto
+
+    /**
+     * @brief Concatena la base y una extensión en memoria nueva
+     * @param base Ruta base
+     * @param ext Extensión (con el punto)
+     * @return Cadena terminada en '\0' (liberar con delete[])
+     */
+    static char* unir(const char* base, const char* ext) {
+        size_t a = strlen(base), b = strlen(ext);
+        char* r = new char[a + b + 1];
+        memcpy(r, base, a);
+        memcpy(r + a, ext, b + 1);
+        return r;
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param base Ruta base de los archivos
+     * @param cada Líneas o bloques entre puntos de control (al menos 1)
+     */
+    PuntoControl(const char* base, long cada)
+        : rutaEstado(unir(base, ".ckpt")), rutaTemporal(unir(base, ".ckpt.tmp")),
+          rutaMensaje(unir(base, ".msg")), mensaje(nullptr),
+          cadaN(cada > 0 ? cada : 1), desdeUltimo(0) {}
+
+    /**
+     * @brief Destructor - cierra el .msg y libera las rutas
+     */
+    ~PuntoControl() {
+        if (mensaje) fclose(mensaje);
+        delete[] rutaEstado;
+        delete[] rutaTemporal;
+        delete[] rutaMensaje;
+    }
+
+    /**
+     * @brief Lee el último punto de control
+     * @param e Recibe el estado guardado
+     * @return false si no existe o está mal formado
+     */
+    bool leer(EstadoControl& e) const {
+        FILE* f = fopen(rutaEstado, "r");
+        if (!f) return false;
+        int version = 0;
+        int n = fscanf(f, "PRT7CKPT %d rotor=%d secuencia=%lld bytes=%lld longitud=%ld "
+                          "load=%ld map=%ld invalidas=%ld rotaciones=%ld",
+                       &version, &e.posicionRotor, &e.secuencia, &e.bytes, &e.longitud,
+                       &e.loads, &e.maps, &e.invalidas, &e.rotaciones);
+        fclose(f);
+        return n == 9 && version == 1 && e.bytes >= 0 && e.longitud >= 0;
+    }
+
+    /**
+     * @brief Abre el .msg donde se escribirá el mensaje
+     * @param reanudar true para conservar los primeros longitud bytes y
+     * continuar tras ellos; false para empezar un mensaje vacío
+     * @param longitud Fragmentos válidos según el punto de control
+     * @return Archivo listo para escribir, o nullptr si falla (ver errno)
+     */
+    FILE* abrirMensaje(bool reanudar, long longitud) {
+        if (!reanudar) {
+            mensaje = fopen(rutaMensaje, "w");
+            return mensaje;
+        }
+        mensaje = fopen(rutaMensaje, "r+");
+        if (!mensaje) return nullptr;
+#ifdef __linux__
+        // Lo escrito tras el último punto de control se vuelve a decodificar
+        if (ftruncate(fileno(mensaje), (off_t)longitud) != 0) {
+            fclose(mensaje);
+            mensaje = nullptr;
+            return nullptr;
+        }
+#endif
+        if (fseek(mensaje, longitud, SEEK_SET) != 0) {
+            fclose(mensaje);
+            mensaje = nullptr;
+            return nullptr;
+        }
+        return mensaje;
+    }
+
+    /**
+     * @brief Cuenta una línea o bloque procesado
+     * @return true si toca guardar un punto de control
+     */
+    bool tocaGuardar() {
+        if (++desdeUltimo < cadaN) return false;
+        desdeUltimo = 0;
+        return true;
+    }
+
+    /**
+     * @brief Reemplaza el .ckpt con un estado nuevo
+     * @param e Estado a guardar (el .msg ya debe contener e.longitud bytes)
+     * @return false si no se pudo escribir
+     * @details Escribe un temporal y lo renombra: tras un corte queda el
+     * estado anterior o el nuevo, nunca uno a medias.
+     */
+    bool guardar(const EstadoControl& e) {
+        desdeUltimo = 0;
+        FILE* f = fopen(rutaTemporal, "w");
+        if (!f) return false;
+        fprintf(f, "PRT7CKPT 1 rotor=%d secuencia=%lld bytes=%lld longitud=%ld "
+                   "load=%ld map=%ld invalidas=%ld rotaciones=%ld\n",
+                e.posicionRotor, e.secuencia, e.bytes, e.longitud,
+                e.loads, e.maps, e.invalidas, e.rotaciones);
+        bool ok = (fclose(f) == 0);
+        return ok && rename(rutaTemporal, rutaEstado) == 0;
+    }
+
+    /**
+     * @brief Ruta del archivo de estado, para los mensajes de consola
+     * @return <base>.ckpt
+     */
+    const char* getRutaEstado() const { return rutaEstado; }
+
+    /**
+     * @brief Ruta del archivo del mensaje, para los mensajes de consola
+     * @return <base>.msg
+     */
+    const char* getRutaMensaje() const { return rutaMensaje; }
+};
+
+#endif // PRT7_PUNTO_CONTROL_H
@@ -0,0 +1,163 @@
+/**
+ * @file ritmo.h
+ * @brief Reproducción de capturas a ritmo de tiempo real (--replay-rate, --replay-baud)
+ *
+ * @details
+ * Para probar con carga el decodificador y lo que consume su salida, --sim
+ * puede entregar las tramas de la captura al ritmo de un sensor en lugar
+ * de tan rápido como se leen: un número fijo de tramas por segundo, o el
+ * tiempo que tardarían sus bytes en llegar por un serial 8N1 a la
+ * velocidad indicada. La captura se precarga en memoria antes de empezar
+ * para que los fallos de página no se sumen al horario.
+ *
+ * El horario es absoluto (trama i en inicio + i * periodo): si una trama
+ * sale tarde, las siguientes salen sin espera hasta recuperarlo, como en
+ * un enlace real con un buffer del lado del emisor.
+ */
+
+#ifndef PRT7_RITMO_H
+#define PRT7_RITMO_H
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+
+#ifdef __linux__
+#include <time.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+#include "estructuras.h"
+#include "latencia.h"
+
+/**************************************************************************
+ * @class CadenciaReproduccion
+ * @brief Espera hasta el horario de cada trama y mide cuánto se desvía
+ *
+ * @details
+ * La espera duerme con clock_nanosleep(TIMER_ABSTIME) hasta MARGEN_NS
+ * antes del objetivo y completa el resto consultando el reloj, porque el
+ * planificador suele despertar decenas de microsegundos tarde. A 2 Mbaud
+ * una línea "L,X" dura 25 µs, así que a esos ritmos la espera es activa.
+ * El retraso de cada trama respecto de su horario va a un HistogramaHdr.
+ **************************************************************************/
+class CadenciaReproduccion {
+private:
+    static const long long MARGEN_NS = 80000;   ///< Tramo final de la espera que se hace activa
+
+    bool porBaudios;         ///< true: horario por bytes a baudios; false: tramas por segundo
+    double nsPorUnidad;      ///< ns por trama, o por byte en modo baudios
+    double objetivoPorSeg;   ///< Tramas/s o baudios pedidos (para el informe)
+    volatile sig_atomic_t* detener;  ///< Bandera externa para cortar la espera
+    long long inicioNs;      ///< Horario de la trama 0
+    long long tramas;        ///< Tramas entregadas
+    long long bytes;         ///< Bytes entregados
+    long long ultimaNs;      ///< Momento de la última entrega
+    long long atrasadas;     ///< Tramas entregadas más de un periodo tarde
+    HistogramaHdr retraso;   ///< ns entre el horario y la entrega
+
+    /**
+     * @brief Horario de una trama
+     * @param bytesHasta Bytes entregados al terminar la trama
+     * @param n Tramas entregadas antes de ella
+     * @return Instante de relojNs() en que le toca salir
+     */
+    long long horario(long long bytesHasta, long long n) const {
+        double unidades = porBaudios ? (double)bytesHasta : (double)n;
+        return inicioNs + (long long)(unidades * nsPorUnidad);
+    }
+
+    /**
+     * @brief Espera hasta un instante de relojNs()
+     * @param objetivo Instante absoluto en ns
+     */
+    void esperarHasta(long long objetivo) {
+        long long dormir = objetivo - MARGEN_NS;
+        if (dormir > relojNs()) {
+#ifdef __linux__
+            struct timespec ts;
+            ts.tv_sec = (time_t)(dormir / 1000000000LL);
+            ts.tv_nsec = (long)(dormir % 1000000000LL);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+                if (detener && *detener) return;
+            }
+#else
+            std::this_thread::sleep_for(std::chrono::nanoseconds(dormir - relojNs()));
+#endif
+        }
+        while (relojNs() < objetivo) {
+            if (detener && *detener) return;
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor
+     * @param tramasPorSeg Tramas por segundo (se usa si baudios <= 0)
+     * @param baudios Velocidad del serial simulado (8N1: 10 bits por byte), o 0
+     * @param bandera Bandera que interrumpe la espera (p. ej. SIGINT), o nullptr
+     */
+    CadenciaReproduccion(double tramasPorSeg, long baudios, volatile sig_atomic_t* bandera)
+        : porBaudios(baudios > 0),
+          nsPorUnidad(baudios > 0 ? 10.0 * 1e9 / (double)baudios : 1e9 / tramasPorSeg),
+          objetivoPorSeg(baudios > 0 ? (double)baudios : tramasPorSeg), detener(bandera),
+          inicioNs(0), tramas(0), bytes(0), ultimaNs(0), atrasadas(0) {}
+
+    /**
+     * @brief Espera al horario de la siguiente trama
+     * @param largo Bytes de la trama en la captura (con su fin de línea)
+     * @details La primera trama fija el origen del horario. En modo
+     * baudios la trama está completa cuando llega su último byte.
+     */
+    void esperar(long long largo) {
+        if (tramas == 0) inicioNs = relojNs();
+        bytes += largo;
+        long long objetivo = horario(bytes, tramas);
+        esperarHasta(objetivo);
+        ultimaNs = relojNs();
+        long long tarde = ultimaNs - objetivo;
+        retraso.registrar(tarde);
+        double periodo = porBaudios ? (double)largo * nsPorUnidad : nsPorUnidad;
+        if ((double)tarde > periodo) ++atrasadas;
+        ++tramas;
+    }
+
+    /**
+     * @brief Indica si la siguiente trama todavía no tiene que salir
+     * @param largo Bytes de la trama
+     * @return true si esperar(largo) va a esperar (para vaciar antes la salida)
+     */
+    bool tocaEsperar(long long largo) const {
+        return tramas > 0 && horario(bytes + largo, tramas) > relojNs();
+    }
+
+    /**
+     * @brief Momento en que se entregó la última trama
+     * @return relojNs() al terminar la última espera (llegada simulada)
+     */
+    long long getUltimaEntregaNs() const { return ultimaNs; }
+
+    /**
+     * @brief Escribe en stderr el ritmo logrado frente al pedido y el desvío
+     */
+    void imprimirResumen() const {
+        double seg = tramas > 1 ? (double)(ultimaNs - inicioNs) / 1e9 : 0.0;
+        double tasa = seg > 0 ? (double)(tramas - 1) / seg : 0.0;
+        double baudios = seg > 0 ? (double)bytes * 10.0 / seg : 0.0;
+        fprintf(stderr, "reproducción: %lld tramas, %lld bytes en %.3f s\n", tramas, bytes, seg);
+        if (porBaudios)
+            fprintf(stderr, "  objetivo %.0f baudios, logrado %.0f baudios (%.0f tramas/s)\n",
+                    objetivoPorSeg, baudios, tasa);
+        else
+            fprintf(stderr, "  objetivo %.1f tramas/s, logrado %.1f tramas/s (%.0f baudios)\n",
+                    objetivoPorSeg, tasa, baudios);
+        fprintf(stderr, "  retraso sobre el horario (us): p50 %.1f  p99 %.1f  p999 %.1f  max %.1f; "
+                        "%lld tramas con más de un periodo de retraso\n",
+                (double)retraso.percentil(0.5) / 1e3, (double)retraso.percentil(0.99) / 1e3,
+                (double)retraso.percentil(0.999) / 1e3, (double)retraso.maximo / 1e3, atrasadas);
+    }
+};
+
+#endif // PRT7_RITMO_H
@@ -0,0 +1,254 @@
+/**
+ * @file salida_asincrona.h
+ * @brief Escritura de la consola en un hilo aparte con writev (--async-output)
+ *
+ * @details
+ * Toda la salida del decodificador (traza, mensaje y resúmenes) pasa por
+ * std::cout. SalidaAsincrona se instala como su streambuf: el hilo de
+ * decodificación solo copia bytes a buffers grandes y los publica; un hilo
+ * escritor los junta y los escribe con un único writev(). Así una terminal
+ * lenta o una tubería llena no detienen el bucle de tramas mientras quede
+ * algún buffer libre. Solo está disponible en Linux.
+ */
+
+#ifndef PRT7_SALIDA_ASINCRONA_H
+#define PRT7_SALIDA_ASINCRONA_H
+
+#ifdef __linux__
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <iostream>
+#include <streambuf>
+#include <thread>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**************************************************************************
+ * @class SalidaAsincrona
+ * @brief streambuf de varios buffers vaciados por un hilo escritor
+ *
+ * @details
+ * Los BUFFERES buffers forman una cola circular de un productor (el hilo
+ * que escribe en std::cout) y un consumidor (el hilo escritor), con los
+ * índices publicados con semántica release/acquire como en CanalSPSC.
+ * Un buffer se publica cuando se llena o cuando se vacía cout (std::endl,
+ * flush); el escritor envía de una vez todos los publicados. El productor
+ * solo espera si los BUFFERES buffers están pendientes de escribir, y esa
+ * espera se contabiliza.
+ *
+ * Si la salida falla (p. ej. la tubería se cerró), los datos siguientes se
+ * descartan y getError() devuelve el errno.
+ **************************************************************************/
+class SalidaAsincrona : public std::streambuf {
+private:
+    static const size_t TAM_BUFFER = 1 << 16;  ///< Bytes por buffer
+    static const size_t BUFFERES = 8;          ///< Buffers (potencia de dos)
+    static const size_t MASCARA = BUFFERES - 1; ///< Índice módulo BUFFERES
+    static const int GIROS = 64;               ///< Reintentos con yield antes de dormir
+
+    int fd;                                    ///< Descriptor de salida
+    char* memoria;                             ///< BUFFERES * TAM_BUFFER bytes
+    size_t largos[BUFFERES];                   ///< Bytes válidos de cada buffer publicado
+    std::atomic<size_t> publicados;            ///< Buffers publicados (productor)
+    char relleno1[64];                         ///< Separa los índices en líneas de caché
+    std::atomic<size_t> escritos;              ///< Buffers ya escritos (escritor)
+    char relleno2[64];                         ///< Separa escritos del resto del estado
+    std::atomic<bool> cerrado;                 ///< El productor ya no publicará más
+    std::thread hilo;                          ///< Hilo escritor
+    std::streambuf* anterior;                  ///< streambuf de cout antes de activar()
+    long esperasLleno;                         ///< Veces que el productor halló todo pendiente
+    long llamadas;                             ///< Llamadas a writev (escritor)
+    long long bytes;                           ///< Bytes escritos (escritor)
+    int error;                                 ///< errno del primer fallo (0 = ninguno)
+
+    /**
+     * @brief Espera breve: cede la CPU y, tras varios intentos, duerme
+     * @param intento Número de intentos consecutivos hasta ahora
+     */
+    static void esperar(int intento) {
+        if (intento < GIROS) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    /**
+     * @brief Buffer de una posición de la cola
+     * @param i Número de buffer (se reduce módulo BUFFERES)
+     * @return Inicio del buffer
+     */
+    char* buffer(size_t i) const { return memoria + (i & MASCARA) * TAM_BUFFER; }
+
+    /**
+     * @brief Publica el buffer en curso y pasa al siguiente (productor)
+     * @details No publica buffers vacíos. Si todos los buffers están
+     * pendientes, espera a que el escritor libere uno.
+     */
+    void publicar() {
+        size_t p = publicados.load(std::memory_order_relaxed);
+        size_t n = (size_t)(pptr() - pbase());
+        if (n == 0) return;
+        largos[p & MASCARA] = n;
+        publicados.store(p + 1, std::memory_order_release);
+        ++p;
+        if (p - escritos.load(std::memory_order_acquire) == BUFFERES) {
+            ++esperasLleno;
+            for (int i = 0; p - escritos.load(std::memory_order_acquire) == BUFFERES; ++i)
+                esperar(i);
+        }
+        setp(buffer(p), buffer(p) + TAM_BUFFER);
+    }
+
+    /**
+     * @brief Escribe todo el vector, reintentando las escrituras parciales
+     * @param iov Segmentos (se modifican)
+     * @param n Número de segmentos
+     */
+    void escribirTodo(struct iovec* iov, int n) {
+        while (n > 0 && error == 0) {
+            ssize_t w = writev(fd, iov, n);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                error = errno;
+                return;
+            }
+            ++llamadas;
+            bytes += w;
+            while (n > 0 && (size_t)w >= iov->iov_len) {
+                w -= (ssize_t)iov->iov_len;
+                ++iov;
+                --n;
+            }
+            if (n > 0) {
+                iov->iov_base = (char*)iov->iov_base + w;
+                iov->iov_len -= (size_t)w;
+            }
+        }
+    }
+
+    /**
+     * @brief Bucle del hilo escritor
+     * @details Junta en un writev() todos los buffers publicados desde la
+     * última vuelta y termina cuando el productor cerró y no queda nada.
+     */
+    void escritor() {
+        struct iovec iov[BUFFERES];
+        size_t e = escritos.load(std::memory_order_relaxed);
+        for (int intento = 0; ; ) {
+            size_t p = publicados.load(std::memory_order_acquire);
+            if (p == e) {
+                if (cerrado.load(std::memory_order_acquire)
+                    && publicados.load(std::memory_order_acquire) == e)
+                    return;
+                esperar(intento++);
+                continue;
+            }
+            intento = 0;
+            int n = 0;
+            for (size_t i = e; i != p; ++i, ++n) {
+                iov[n].iov_base = buffer(i);
+                iov[n].iov_len = largos[i & MASCARA];
+            }
+            escribirTodo(iov, n);
+            e = p;
+            escritos.store(e, std::memory_order_release);
+        }
+    }
+
+protected:
+    /**
+     * @brief Buffer en curso lleno: lo publica y guarda el carácter
+     * @param c Carácter que no cupo
+     * @return c, o EOF si c es EOF
+     */
+    virtual int_type overflow(int_type c) {
+        publicar();
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+
+    /**
+     * @brief std::flush / std::endl: publica lo acumulado sin esperar la escritura
+     * @return 0
+     */
+    virtual int sync() {
+        publicar();
+        return 0;
+    }
+
+public:
+    /**
+     * @brief Constructor - inactivo: sin buffers ni hilo hasta activar()
+     * @param descriptor Destino de la salida (1 = stdout)
+     */
+    explicit SalidaAsincrona(int descriptor = 1)
+        : fd(descriptor), memoria(nullptr), publicados(0), escritos(0), cerrado(false),
+          anterior(nullptr), esperasLleno(0), llamadas(0), bytes(0), error(0) {
+        static_assert((BUFFERES & (BUFFERES - 1)) == 0, "BUFFERES debe ser potencia de dos");
+    }
+
+    /**
+     * @brief Destructor - escribe lo pendiente y devuelve cout a su streambuf
+     */
+    ~SalidaAsincrona() {
+        terminar();
+        delete[] memoria;
+    }
+
+    /**
+     * @brief Reserva los buffers, arranca el hilo escritor y se instala
+     * como streambuf de std::cout
+     * @post Lo que hubiera en el streambuf anterior ya se vació
+     */
+    void activar() {
+        if (anterior) return;
+        if (!memoria) memoria = new char[BUFFERES * TAM_BUFFER];
+        setp(buffer(0), buffer(0) + TAM_BUFFER);
+        std::cout.flush();
+        hilo = std::thread(&SalidaAsincrona::escritor, this);
+        anterior = std::cout.rdbuf(this);
+    }
+
+    /**
+     * @brief Publica lo pendiente, espera al escritor y restaura std::cout
+     * @post Toda la salida aceptada está escrita (o descartada por error)
+     */
+    void terminar() {
+        if (!anterior) return;
+        publicar();
+        cerrado.store(true, std::memory_order_release);
+        hilo.join();
+        std::cout.rdbuf(anterior);
+        anterior = nullptr;
+    }
+
+    /**
+     * @brief Veces que el decodificador esperó por no haber buffer libre
+     * @return Contador de contrapresión de la salida
+     */
+    long getEsperasLleno() const { return esperasLleno; }
+
+    /**
+     * @brief Llamadas a writev realizadas (válido tras terminar())
+     * @return Contador de escrituras
+     */
+    long getLlamadas() const { return llamadas; }
+
+    /**
+     * @brief Bytes escritos (válido tras terminar())
+     * @return Total escrito en el descriptor
+     */
+    long long getBytes() const { return bytes; }
+
+    /**
+     * @brief Primer error de escritura (válido tras terminar())
+     * @return errno, o 0 si no hubo errores
+     */
+    int getError() const { return error; }
+};
+#endif // __linux__
+
+#endif // PRT7_SALIDA_ASINCRONA_H
@@ -0,0 +1,807 @@
+/**
+ * @file serial_reader.h
+ * @brief Lectura de tramas desde puerto serial o archivo de simulación
+ */
+
+#ifndef PRT7_SERIAL_READER_H
+#define PRT7_SERIAL_READER_H
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+
+#ifdef __linux__
+#include <termios.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "estructuras.h"
+#include "binario.h"
+
+#ifdef __linux__
+/**
+ * @brief Traduce un baud rate numérico a su constante termios
+ * @param baud Velocidad en bits por segundo
+ * @param velocidad Recibe la constante Bxxxx correspondiente
+ * @return true si la velocidad es una de las estándar de termios
+ */
+inline bool velocidadTermios(int baud, speed_t& velocidad) {
+    static const struct { int baud; speed_t v; } tabla[] = {
+        {50, B50}, {75, B75}, {110, B110}, {134, B134}, {150, B150},
+        {200, B200}, {300, B300}, {600, B600}, {1200, B1200}, {1800, B1800},
+        {2400, B2400}, {4800, B4800}, {9600, B9600}, {19200, B19200},
+        {38400, B38400}, {57600, B57600}, {115200, B115200}, {230400, B230400},
+#ifdef B460800
+        {460800, B460800}, {500000, B500000}, {576000, B576000},
+        {921600, B921600}, {1000000, B1000000}, {1152000, B1152000},
+        {1500000, B1500000}, {2000000, B2000000}, {2500000, B2500000},
+        {3000000, B3000000}, {3500000, B3500000}, {4000000, B4000000},
+#endif
+    };
+    for (size_t i = 0; i < sizeof(tabla) / sizeof(tabla[0]); ++i) {
+        if (tabla[i].baud == baud) {
+            velocidad = tabla[i].v;
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(TCGETS2) && (defined(__x86_64__) || defined(__i386__) || \
+                         defined(__aarch64__) || defined(__arm__))
+#define PRT7_TERMIOS2 1
+/**
+ * @struct Termios2
+ * @brief Equivalente a struct termios2 del kernel (asm-generic)
+ * @details Permite fijar baud rates arbitrarios con BOTHER; se declara aquí
+ * porque <asm/termbits.h> choca con <termios.h> de glibc.
+ */
+struct Termios2 {
+    tcflag_t c_iflag;    ///< Modos de entrada
+    tcflag_t c_oflag;    ///< Modos de salida
+    tcflag_t c_cflag;    ///< Modos de control
+    tcflag_t c_lflag;    ///< Modos locales
+    cc_t c_line;         ///< Disciplina de línea
+    cc_t c_cc[19];       ///< Caracteres de control (NCCS del kernel)
+    speed_t c_ispeed;    ///< Velocidad de entrada
+    speed_t c_ospeed;    ///< Velocidad de salida
+};
+
+/**
+ * @brief Fija un baud rate no estándar con termios2/BOTHER
+ * @param fd Descriptor del puerto serial ya configurado
+ * @param baud Velocidad en bits por segundo
+ * @return true si el kernel aceptó la velocidad
+ */
+inline bool fijarBaudArbitrario(int fd, int baud) {
+    const unsigned long obtener = _IOR('T', 0x2A, Termios2);
+    const unsigned long fijar = _IOW('T', 0x2B, Termios2);
+    const tcflag_t bother = 0010000;     // BOTHER en asm-generic/termbits.h
+    Termios2 t2;
+    if (ioctl(fd, obtener, &t2) != 0) return false;
+    t2.c_cflag &= ~(tcflag_t)CBAUD;
+    t2.c_cflag |= bother;
+    t2.c_ispeed = (speed_t)baud;
+    t2.c_ospeed = (speed_t)baud;
+    return ioctl(fd, fijar, &t2) == 0;
+}
+#endif
+#endif
+
+/**************************************************************************
+ * @struct ReposoLector
+ * @brief Trabajo que el dueño del lector hace mientras la fuente no entrega
+ *
+ * @details
+ * SerialReader lo invoca en el hilo que lee, justo antes de que una
+ * lectura se bloquee por falta de datos, para que lo ya recibido no quede
+ * retenido en un lote mientras la fuente está en silencio. También cuando
+ * una señal interrumpe la espera y, con periodo, cada cierto tiempo
+ * mientras dura (para la línea periódica de --stats).
+ **************************************************************************/
+struct ReposoLector {
+    virtual ~ReposoLector() {}
+
+    /**
+     * @brief La fuente no tiene datos listos y la lectura va a esperar (o sigue esperando)
+     */
+    virtual void enReposo() = 0;
+};
+
+/**************************************************************************
+ * @class SerialReader
+ * @brief Clase para leer datos desde puerto serial o archivo de simulación
+ * 
+ * @details
+ * Intenta abrir un puerto serial en Linux. Si falla, intenta abrir como
+ * archivo de texto para simulación. Lee en bloques grandes con read(2)
+ * sobre un buffer propio y entrega cada línea como una vista (puntero +
+ * longitud) dentro de ese buffer, sin copiarla. Los archivos regulares
+ * (--sim) se proyectan en memoria con mmap y se recorren directamente
+ * desde la caché de páginas. Si la fuente empieza con la marca de
+ * sincronía del formato binario (binario.h), se lee por bloques con
+ * leerBloque() en lugar de por líneas.
+ **************************************************************************/
+class SerialReader {
+private:
+    static const size_t CAPACIDAD = 64 * 1024;  ///< Tamaño del buffer de lectura
+
+    FILE* f;             ///< File pointer para lectura (sin fd disponible)
+    bool is_serial;      ///< Indica si es puerto serial real
+#ifdef __linux__
+    int fd;              ///< File descriptor (Linux)
+#endif
+    char* buffer;        ///< Buffer de lectura
+    size_t inicio;       ///< Primer byte aún no entregado
+    size_t fin;          ///< Fin de los datos válidos en el buffer
+    bool agotado;        ///< La fuente ya no entregará más datos
+    const char* mapa;    ///< Archivo proyectado en memoria (o nullptr)
+    size_t tamMapa;      ///< Tamaño de la proyección
+    size_t posMapa;      ///< Posición de lectura dentro de la proyección
+    int esperaMs;        ///< Tiempo máximo de inactividad del serial (-1 = sin límite)
+    int vmin;            ///< VMIN: bytes mínimos por read() en el serial
+    int vtime;           ///< VTIME: plazo entre bytes en décimas de segundo
+    volatile sig_atomic_t* detener;  ///< Bandera externa para terminar la espera
+    Verbosidad nivel;    ///< Nivel de detalle de los avisos del lector
+    long descartados;    ///< Bloques binarios descartados por CRC o longitud
+    bool sinEspera;      ///< Si es true, las lecturas solo usan lo ya recibido (ver bombear())
+    long long leidos;    ///< Bytes leídos de la fuente por read()/fread() (incluye el buffer)
+    bool marcarLlegadas; ///< Tomar la hora de cada lectura (ver getLlegadaNs())
+    long long llegadaNs; ///< relojNs() al volver la última lectura con datos
+    ReposoLector* reposo; ///< Aviso antes de bloquearse en la fuente (nullptr = ninguno)
+    int periodoReposoMs; ///< Repetición del aviso mientras no llegan datos (-1 = solo una vez)
+
+    /**
+     * @brief Avisa a reposo si la próxima lectura de fd va a bloquearse
+     * @details Un poll() sin plazo por lectura; solo con reposo fijado
+     */
+    void avisarReposo() {
+#ifdef __linux__
+        if (!reposo || fd == -1) return;
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, 0) == 0) reposo->enReposo();
+#endif
+    }
+
+    /**
+     * @brief Espera datos en un descriptor que no es serial, repitiendo el aviso
+     * @return false si se pidió detener
+     * @details Solo con periodoReposoMs > 0; sin él la lectura se bloquea
+     * directamente en read()
+     */
+    bool esperarConReposo() {
+#ifdef __linux__
+        for (;;) {
+            if (detener && *detener) return false;
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int r = poll(&pfd, 1, periodoReposoMs);
+            if (r > 0 || (r < 0 && errno != EINTR)) return true;
+            reposo->enReposo();
+        }
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * @brief Espera con poll() a que el puerto serial tenga datos
+     * @return true si hay datos (o un evento que read() debe atender);
+     * false si venció el tiempo de inactividad, se pidió detener o la
+     * línea se colgó sin datos pendientes
+     * @details No hace espera activa: el hilo duerme en el kernel hasta
+     * que llegan bytes, vence el plazo o una señal interrumpe la espera.
+     * Con un aviso periódico (fijarReposo()) la espera se parte en tramos
+     * de periodoReposoMs que suman el mismo plazo de inactividad.
+     */
+    bool esperarDatos() {
+#ifdef __linux__
+        int sinDatosMs = 0;
+        for (;;) {
+            if (detener && *detener) return false;
+            std::cout.flush();
+            int plazo = esperaMs < 0 ? -1 : esperaMs - sinDatosMs;
+            bool tramo = reposo && periodoReposoMs > 0 && (plazo < 0 || plazo > periodoReposoMs);
+            if (tramo) plazo = periodoReposoMs;
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            int r = poll(&pfd, 1, plazo);
+            if (r > 0) {
+                // Tras colgarse la línea (POLLHUP) solo queda leer lo ya recibido
+                if (pfd.revents & (POLLERR | POLLNVAL)) return false;
+                return (pfd.revents & POLLIN) != 0;
+            }
+            if (r == 0 && tramo) {
+                sinDatosMs += plazo;
+                reposo->enReposo();
+                continue;
+            }
+            if (r == 0) {
+                if (nivel >= VERB_RESUMEN)
+                    std::cout << "Sin datos durante " << esperaMs << " ms. Fin de la sesión." << std::endl;
+                return false;
+            }
+            if (errno != EINTR) return false;
+            if (reposo) reposo->enReposo();
+        }
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Proyecta en memoria un archivo regular ya abierto en fd
+     * @return true si se pudo proyectar
+     * @details Con MADV_SEQUENTIAL el kernel adelanta la lectura y libera
+     * las páginas ya recorridas. Archivos vacíos o no regulares (pipes,
+     * /dev/stdin) siguen por read(2).
+     */
+    bool proyectar() {
+#ifdef __linux__
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+            return false;
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) return false;
+        madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+        mapa = (const char*)p;
+        tamMapa = (size_t)st.st_size;
+        posMapa = 0;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Desplaza al inicio del buffer los bytes aún no entregados
+     */
+    void compactar() {
+        if (inicio > 0) {
+            memmove(buffer, buffer + inicio, fin - inicio);
+            fin -= inicio;
+            inicio = 0;
+        }
+    }
+
+    /**
+     * @brief Lee más datos de la fuente al final del buffer
+     * @return Número de bytes leídos (0 si la fuente se agotó)
+     * @details Antes de leer desplaza al inicio la línea parcial pendiente,
+     * de modo que el buffer funciona como una ventana deslizante.
+     */
+    size_t rellenar() {
+        if (sinEspera) return 0;
+        compactar();
+        if (fin == CAPACIDAD) return 0;
+
+        long n = 0;
+        avisarReposo();
+#ifdef __linux__
+        if (fd != -1 && is_serial) {
+            // Esperar con poll() y luego leer lo que el kernel haya agrupado
+            // según VMIN/VTIME; con poll() ya listo, read() == 0 es que la
+            // línea se colgó (desconexión USB, módem), no que venció VTIME
+            for (;;) {
+                if (!esperarDatos()) {
+                    n = 0;
+                    break;
+                }
+                n = (long)read(fd, buffer + fin, CAPACIDAD - fin);
+                if (n >= 0) break;
+                if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
+                    break;
+            }
+        } else if (fd != -1) {
+            if (reposo && periodoReposoMs > 0 && !esperarConReposo()) {
+                agotado = true;
+                return 0;
+            }
+            for (;;) {
+                n = (long)read(fd, buffer + fin, CAPACIDAD - fin);
+                if (n >= 0 || errno != EINTR || (detener && *detener)) break;
+                if (reposo) reposo->enReposo();
+            }
+        } else
+#endif
+        if (f) {
+            n = (long)fread(buffer + fin, 1, CAPACIDAD - fin, f);
+        }
+        if (n <= 0) {
+            agotado = true;
+            return 0;
+        }
+        fin += (size_t)n;
+        leidos += n;
+        if (marcarLlegadas) llegadaNs = relojNs();
+        return (size_t)n;
+    }
+
+    /**
+     * @brief Garantiza que haya al menos n bytes sin entregar
+     * @param n Bytes requeridos (mucho menor que CAPACIDAD)
+     * @param disp Recibe los bytes disponibles (menos de n si la fuente se agotó)
+     * @return Puntero al primer byte sin entregar
+     */
+    const unsigned char* asegurar(size_t n, size_t& disp) {
+        if (mapa) {
+            disp = tamMapa - posMapa;
+            return (const unsigned char*)mapa + posMapa;
+        }
+        while (fin - inicio < n && !agotado && rellenar() > 0) {}
+        disp = fin - inicio;
+        return (const unsigned char*)buffer + inicio;
+    }
+
+    /**
+     * @brief Marca como entregados n bytes
+     * @param n Bytes consumidos
+     */
+    void consumir(size_t n) {
+        if (mapa) posMapa += n;
+        else inicio += n;
+    }
+
+public:
+    /**
+     * @brief Constructor por defecto
+     */
+    SerialReader() : f(nullptr), is_serial(false)
+#ifdef __linux__
+    , fd(-1)
+#endif
+    , buffer(new char[CAPACIDAD]), inicio(0), fin(0), agotado(false)
+    , mapa(nullptr), tamMapa(0), posMapa(0), esperaMs(-1), vmin(1), vtime(0)
+    , detener(nullptr), nivel(VERB_TRAZA), descartados(0), sinEspera(false), leidos(0)
+    , marcarLlegadas(false), llegadaNs(0), reposo(nullptr), periodoReposoMs(-1)
+    {}
+
+    /**
+     * @brief Destructor - cierra puerto/archivo
+     */
+    ~SerialReader() {
+#ifdef __linux__
+        if (mapa) munmap((void*)mapa, tamMapa);
+        if (fd != -1) {
+            close(fd);
+        }
+#endif
+        if (f) fclose(f);
+        delete[] buffer;
+    }
+
+    /**
+     * @brief Configura la espera del puerto serial
+     * @param timeoutMs Tiempo máximo sin datos antes de terminar (-1 = sin límite)
+     * @param bandera Si no es nullptr y se vuelve distinta de 0, la espera termina
+     */
+    void configurarEspera(int timeoutMs, volatile sig_atomic_t* bandera) {
+        esperaMs = (timeoutMs < 0 ? -1 : timeoutMs);
+        detener = bandera;
+    }
+
+    /**
+     * @brief Fija el nivel de detalle de los avisos del lector
+     * @param v Nivel de verbosidad; en VERB_SILENCIO solo se reportan errores
+     */
+    void fijarVerbosidad(Verbosidad v) { nivel = v; }
+
+    /**
+     * @brief Configura cómo agrupa el kernel los bytes del serial
+     * @param minimo VMIN: bytes mínimos que debe devolver cada read() (0-255)
+     * @param decimas VTIME: plazo entre bytes en décimas de segundo (0-255)
+     * @details Debe llamarse antes de abrir(). Con VMIN alto el kernel
+     * entrega lecturas más grandes; VTIME evita quedarse esperando un
+     * bloque incompleto cuando el emisor hace una pausa.
+     */
+    void configurarLectura(int minimo, int decimas) {
+        vmin = (minimo < 0 ? 0 : (minimo > 255 ? 255 : minimo));
+        vtime = (decimas < 0 ? 0 : (decimas > 255 ? 255 : decimas));
+    }
+
+    /**
+     * @brief Abre un puerto serial o archivo de simulación
+     * @param path Ruta del dispositivo (/dev/ttyUSB0) o archivo
+     * @param baud Baud rate para puerto serial (default: 9600)
+     * @return true si se abrió correctamente
+     * @details Intenta primero como puerto serial (Linux), luego como archivo.
+     * Las velocidades estándar de termios se fijan con cfsetspeed; las demás
+     * con termios2/BOTHER cuando el kernel lo permite.
+     */
+    bool abrir(const char* path, int baud = 9600) {
+#ifdef __linux__
+        // Intentar como puerto serial
+        fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+        if (fd != -1) {
+            struct termios tty;
+            if (tcgetattr(fd, &tty) == 0) {
+                speed_t velocidad = B9600;
+                bool estandar = velocidadTermios(baud, velocidad);
+                cfmakeraw(&tty);
+                cfsetspeed(&tty, velocidad);
+                tty.c_cflag &= ~PARENB;
+                tty.c_cflag &= ~CSTOPB;
+                tty.c_cflag &= ~CSIZE;
+                tty.c_cflag |= CS8;
+                tty.c_cflag |= CREAD | CLOCAL;
+                tty.c_cc[VMIN] = (cc_t)vmin;
+                tty.c_cc[VTIME] = (cc_t)vtime;
+                tcsetattr(fd, TCSANOW, &tty);
+
+                bool baudOk = estandar;
+#ifdef PRT7_TERMIOS2
+                if (!estandar) baudOk = fijarBaudArbitrario(fd, baud);
+#endif
+                if (!baudOk) {
+                    std::cout << "Baud rate no soportado: " << baud << std::endl;
+                    close(fd);
+                    fd = -1;
+                    return false;
+                }
+
+                // Lecturas bloqueantes: VMIN/VTIME solo aplican sin O_NONBLOCK;
+                // la espera con plazo la hace poll()
+                int flags = fcntl(fd, F_GETFL);
+                if (flags != -1) fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+                
+                is_serial = true;
+                if (nivel >= VERB_RESUMEN) {
+                    std::cout << "Conexión serial abierta en " << path 
+                         << " (" << baud << " baud)" << std::endl;
+                }
+                return true;
+            }
+            close(fd); 
+            fd = -1;
+        }
+
+        // Fallback: archivo de simulación
+        fd = open(path, O_RDONLY);
+        if (fd == -1) {
+            std::cout << "Error abriendo '" << path << "': " 
+                 << strerror(errno) << std::endl;
+            return false;
+        }
+#else
+        // Fallback: archivo de simulación
+        f = fopen(path, "r");
+        if (!f) {
+            std::cout << "Error abriendo '" << path << "': " 
+                 << strerror(errno) << std::endl;
+            return false;
+        }
+#endif
+        is_serial = false;
+#ifdef __linux__
+        proyectar();
+#endif
+        if (nivel >= VERB_RESUMEN)
+            std::cout << "Abierto archivo de simulación: " << path << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief Da acceso directo al archivo proyectado en memoria
+     * @param datos Recibe el inicio de la proyección
+     * @param tam Recibe el tamaño de la proyección
+     * @return false si la fuente no es un archivo proyectado (serial, pipe)
+     */
+    bool datosProyectados(const char*& datos, size_t& tam) const {
+        if (!mapa) return false;
+        datos = mapa;
+        tam = tamMapa;
+        return true;
+    }
+
+    /**
+     * @brief Trae a memoria todas las páginas del archivo proyectado
+     * @return false si la fuente no está proyectada
+     * @details Toca una vez cada página para que las lecturas posteriores
+     * no esperen al disco (ver ritmo.h)
+     */
+    bool precargar() {
+        if (!mapa) return false;
+#ifdef __linux__
+        madvise((void*)mapa, tamMapa, MADV_WILLNEED);
+        long pagina = sysconf(_SC_PAGESIZE);
+        if (pagina <= 0) pagina = 4096;
+        volatile unsigned char suma = 0;
+        for (size_t i = 0; i < tamMapa; i += (size_t)pagina) suma += (unsigned char)mapa[i];
+        (void)suma;
+#endif
+        return true;
+    }
+
+    /**
+     * @brief Entrega la siguiente línea como vista sobre el buffer interno
+     * @param linea Recibe el puntero al primer carácter de la línea
+     * @param len Recibe la longitud de la línea (sin \r\n)
+     * @return true si hay línea; false al agotarse la fuente
+     * @warning La vista no termina en '\0' y solo es válida hasta la
+     * siguiente llamada
+     */
+    bool leerVista(const char*& linea, size_t& len) {
+        if (mapa) {
+            if (posMapa >= tamMapa) return false;
+            const char* base = mapa + posMapa;
+            size_t disponibles = tamMapa - posMapa;
+            const char* nl = (const char*)memchr(base, '\n', disponibles);
+            size_t L = nl ? (size_t)(nl - base) : disponibles;
+            posMapa += L + (nl ? 1 : 0);
+            while (L > 0 && base[L-1] == '\r') --L;
+            linea = base;
+            len = L;
+            // Sin read() la línea "llega" al entregarse
+            if (marcarLlegadas) llegadaNs = relojNs();
+            return true;
+        }
+        for (;;) {
+            const char* base = buffer + inicio;
+            size_t disponibles = fin - inicio;
+            const char* nl = (const char*)memchr(base, '\n', disponibles);
+            if (nl || (disponibles > 0 && (agotado || disponibles == CAPACIDAD))) {
+                // Línea completa, última línea sin '\n', o línea más larga que el buffer
+                size_t L = nl ? (size_t)(nl - base) : disponibles;
+                inicio += L + (nl ? 1 : 0);
+                while (L > 0 && (base[L-1] == '\r' || base[L-1] == '\n')) --L;
+                linea = base;
+                len = L;
+                return true;
+            }
+            if (agotado || rellenar() == 0) {
+                if (agotado && fin > inicio) continue;
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief Indica si la fuente usa el formato binario de bloques
+     * @return true si los próximos bytes son la marca de sincronía
+     * @details Debe llamarse antes de leer; en serial espera los dos
+     * primeros bytes.
+     */
+    bool esFormatoBinario() {
+        size_t disp;
+        const unsigned char* p = asegurar(2, disp);
+        return disp >= 2 && p[0] == BIN_SYNC0 && p[1] == BIN_SYNC1;
+    }
+
+    /**
+     * @brief Entrega el siguiente bloque binario con CRC válido
+     * @param carga Recibe los registros del bloque (sin cabecera ni CRC)
+     * @param len Recibe la longitud de los registros
+     * @return true si hay bloque; false al agotarse la fuente
+     * @details Ante un CRC erróneo o una longitud nula, descarta un byte y
+     * busca la siguiente marca de sincronía.
+     * @warning La vista solo es válida hasta la siguiente llamada
+     */
+    bool leerBloque(const unsigned char*& carga, size_t& len) {
+        for (;;) {
+            size_t disp;
+            const unsigned char* p = asegurar(BIN_CABECERA, disp);
+            if (disp < BIN_CABECERA) return false;
+            if (p[0] != BIN_SYNC0 || p[1] != BIN_SYNC1) {
+                const void* s = memchr(p + 1, BIN_SYNC0, disp - 1);
+                consumir(s ? (size_t)((const unsigned char*)s - p) : disp);
+                continue;
+            }
+            size_t L = p[2];
+            size_t total = BIN_CABECERA + L + 1;
+            p = asegurar(total, disp);
+            if (disp < total) return false;
+            if (L == 0 || crc8(p + 2, L + 1) != p[BIN_CABECERA + L]) {
+                ++descartados;
+                if (nivel >= VERB_TRAZA)
+                    std::cout << "Bloque binario descartado (CRC). Resincronizando..." << '\n';
+                consumir(1);
+                continue;
+            }
+            carga = p + BIN_CABECERA;
+            len = L;
+            consumir(total);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Activa el modo sin espera para multiplexar varias fuentes
+     * @param activo true para que leerVista()/leerBloque() no lean de la fuente
+     * @details En este modo los datos entran solo con bombear(), llamado
+     * cuando epoll indica que el descriptor tiene datos; las lecturas
+     * devuelven false mientras no haya una línea o un bloque completos.
+     * Al activarlo el descriptor pasa a O_NONBLOCK y un serial a VMIN=0,
+     * VTIME=0: con --vmin > 1 el kernel no avisaría a epoll hasta juntar
+     * VMIN bytes, y un read() bloqueante dejaría sin atender a los demás
+     * puertos. Así cada read() de bombear() devuelve lo que haya.
+     */
+    void configurarSinEspera(bool activo) {
+        sinEspera = activo;
+#ifdef __linux__
+        if (!activo || fd == -1 || mapa) return;
+        int flags = fcntl(fd, F_GETFL);
+        if (flags != -1) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        struct termios tty;
+        if (is_serial && tcgetattr(fd, &tty) == 0) {
+            tty.c_cc[VMIN] = 0;
+            tty.c_cc[VTIME] = 0;
+            tcsetattr(fd, TCSANOW, &tty);
+        }
+#endif
+    }
+
+    /**
+     * @brief Hace una única lectura de lo que la fuente tenga disponible
+     * @return false si la fuente se agotó o falló
+     * @details No espera con poll(): se supone que el descriptor está listo
+     */
+    bool bombear() {
+#ifdef __linux__
+        if (mapa) return posMapa < tamMapa;
+        if (agotado) return false;
+        compactar();
+        if (fin == CAPACIDAD) return true;
+        long n;
+        do {
+            n = (long)read(fd, buffer + fin, CAPACIDAD - fin);
+        } while (n < 0 && errno == EINTR);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (n <= 0) {
+            agotado = true;
+            return false;
+        }
+        fin += (size_t)n;
+        leidos += n;
+        if (marcarLlegadas) llegadaNs = relojNs();
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Descriptor de la fuente, para registrarlo en epoll
+     * @return File descriptor, o -1 si no hay
+     */
+    int descriptor() const {
+#ifdef __linux__
+        return fd;
+#else
+        return -1;
+#endif
+    }
+
+    /**
+     * @brief Indica si la fuente es un archivo proyectado en memoria
+     * @return true si se lee desde la proyección (siempre lista)
+     */
+    bool estaProyectado() const { return mapa != nullptr; }
+
+    /**
+     * @brief Indica si la fuente ya no entregará más datos
+     * @return true tras fin de archivo, cierre del dispositivo o proyección recorrida
+     */
+    bool estaAgotado() const { return mapa ? posMapa >= tamMapa : agotado; }
+
+    /**
+     * @brief Bytes recibidos y aún no entregados
+     * @return Bytes pendientes en el buffer o en la proyección
+     */
+    size_t bytesPendientes() const { return mapa ? tamMapa - posMapa : fin - inicio; }
+
+    /**
+     * @brief Posición en la fuente del siguiente byte a entregar
+     * @return Bytes desde el inicio de la fuente ya entregados como líneas o bloques
+     */
+    long long posicion() const {
+        return mapa ? (long long)posMapa : leidos - (long long)(fin - inicio);
+    }
+
+    /**
+     * @brief Continúa la lectura desde una posición absoluta de la fuente
+     * @param pos Valor devuelto antes por posicion()
+     * @return false si la fuente no admite saltos (serial, pipe) o pos está
+     * fuera del archivo
+     * @details En un archivo proyectado el salto es O(1); en el resto de
+     * archivos regulares se hace con lseek/fseek y se descarta el buffer.
+     */
+    bool reposicionar(long long pos) {
+        if (pos < 0) return false;
+        if (mapa) {
+            if ((size_t)pos > tamMapa) return false;
+            posMapa = (size_t)pos;
+            return true;
+        }
+        if (is_serial) return false;
+#ifdef __linux__
+        if (fd != -1 && lseek(fd, (off_t)pos, SEEK_SET) == (off_t)-1) return false;
+#endif
+        if (f && fseek(f, (long)pos, SEEK_SET) != 0) return false;
+        inicio = fin = 0;
+        agotado = false;
+        leidos = pos;
+        return true;
+    }
+
+    /**
+     * @brief Bloques binarios descartados hasta ahora
+     * @return Contador de bloques con CRC o longitud inválidos
+     */
+    long getBloquesDescartados() const { return descartados; }
+
+    /**
+     * @brief Activa la marca de tiempo de llegada de cada lectura
+     * @param activo true para consultar el reloj tras cada read() con datos
+     * @details Desactivada por defecto: sin --latency el lector no mide nada
+     */
+    void fijarMarcaLlegada(bool activo) { marcarLlegadas = activo; }
+
+    /**
+     * @brief Momento en que llegaron los bytes de la última línea entregada
+     * @return relojNs() al volver el read() que trajo su '\n' (en un archivo
+     * proyectado, el de la entrega), o 0 si la marca está desactivada
+     * @details Toda línea entregada por leerVista() termina en los datos
+     * de la última lectura: solo se vuelve a leer cuando en el buffer no
+     * queda ninguna línea completa.
+     */
+    long long getLlegadaNs() const { return llegadaNs; }
+
+    /**
+     * @brief Fija a quién avisar antes de que una lectura se bloquee
+     * @param r Receptor del aviso, o nullptr para no avisar
+     * @param periodoMs Repetir el aviso cada periodoMs mientras no lleguen
+     * datos (-1 = solo antes de bloquearse y al interrumpirlo una señal)
+     * @details El aviso corre en el hilo que llama a leerVista()/leerBloque();
+     * en un archivo proyectado nunca se produce
+     */
+    void fijarReposo(ReposoLector* r, int periodoMs = -1) {
+        reposo = r;
+        periodoReposoMs = periodoMs;
+    }
+
+    /**
+     * @brief Indica si la próxima leerVista() puede entregar una línea sin leer
+     * @return true si hay una línea completa (o la última sin '\n') ya recibida
+     * @details Un false significa que la próxima lectura puede bloquearse en
+     * la fuente: es el momento de vaciar la salida
+     */
+    bool hayLineaCompleta() const {
+        if (mapa) return posMapa < tamMapa;
+        if (fin == inicio) return false;
+        return agotado || fin - inicio == CAPACIDAD
+            || memchr(buffer + inicio, '\n', fin - inicio) != nullptr;
+    }
+
+    /**
+     * @brief Lee una línea del puerto/archivo
+     * @param outBuf Buffer de salida
+     * @param maxLen Tamaño máximo del buffer
+     * @return true si se leyó algo
+     * @post outBuf contiene la línea sin \r\n (truncada a maxLen-1)
+     */
+    bool leerLinea(char* outBuf, size_t maxLen) {
+        const char* p;
+        size_t L;
+        if (maxLen == 0 || !leerVista(p, L)) return false;
+        if (L > maxLen - 1) L = maxLen - 1;
+        memcpy(outBuf, p, L);
+        outBuf[L] = '\0';
+        return true;
+    }
+};
+
+#endif // PRT7_SERIAL_READER_H
@@ -0,0 +1,471 @@
+/**
+ * @file tramas.h
+ * @brief Tramas del protocolo PRT-7 y su parser
+ * 
+ * @details
+ * Jerarquía polimórfica TramaBase / TramaLoad / TramaMap, representación
+ * por valor Trama y las funciones que convierten una línea de texto en
+ * una trama.
+ */
+
+#ifndef PRT7_TRAMAS_H
+#define PRT7_TRAMAS_H
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cctype>
+#include <strings.h>
+
+#include "estructuras.h"
+
+/**************************************************************************
+ * @class TramaBase
+ * @brief Clase base abstracta para todas las tramas del protocolo PRT-7
+ * 
+ * @details
+ * Define la interfaz común para las tramas LOAD y MAP. Utiliza polimorfismo
+ * para permitir el procesamiento uniforme de diferentes tipos de tramas.
+ * El destructor virtual es crítico para la correcta liberación de memoria.
+ **************************************************************************/
+class TramaBase {
+public:
+    /**
+     * @brief Procesa la trama y modifica las estructuras de datos
+     * @param carga Puntero a la lista de carga donde se almacenan fragmentos decodificados
+     * @param rotor Puntero al rotor de mapeo que realiza la decodificación
+     * @pre carga y rotor deben estar inicializados
+     * @post Las estructuras pueden ser modificadas según el tipo de trama
+     */
+    virtual void procesar(ListaDeCarga* carga, RotorActivo* rotor) = 0;
+    
+    /**
+     * @brief Destructor virtual para permitir polimorfismo correcto
+     * @details Esencial para evitar fugas de memoria al eliminar objetos derivados
+     */
+    virtual ~TramaBase() {}
+};
+/**************************************************************************
+ * @class TramaLoad
+ * @brief Trama de tipo LOAD que contiene un fragmento de dato
+ * 
+ * @details
+ * Representa una trama "L,X" donde X es un carácter que debe ser decodificado
+ * usando el estado actual del rotor y agregado a la lista de carga.
+ **************************************************************************/
+class TramaLoad : public TramaBase {
+private:
+    char fragmento;      ///< Carácter a decodificar
+
+public:
+    /**
+     * @brief Constructor
+     * @param f Carácter fragmento de la trama
+     */
+    TramaLoad(char f) : fragmento(f) {}
+    
+    /**
+     * @brief Procesa la trama LOAD
+     * @param carga Lista donde se insertará el fragmento decodificado
+     * @param rotor Rotor usado para decodificar el fragmento
+     * @post El fragmento decodificado se agrega al final de la lista de carga
+     */
+    virtual void procesar(ListaDeCarga* carga, RotorActivo* rotor) {
+        ejecutar(fragmento, carga, rotor);
+    }
+
+    /**
+     * @brief Lógica de una trama LOAD sin necesidad de instanciar el objeto
+     * @param fragmento Carácter a decodificar
+     * @param carga Lista donde se insertará el fragmento decodificado
+     * @param rotor Rotor (o banco de rotores) usado para decodificar el fragmento
+     * @details Compartida por procesar() y por el despacho por valor procesarTrama().
+     * La traza por trama se imprime solo si la carga está en VERB_TRAZA.
+     */
+    template <class Rotor>
+    static void ejecutar(char fragmento, ListaDeCarga* carga, Rotor* rotor) {
+        char dec = rotor->getMapeo(fragmento);
+        carga->insertarAlFinal(dec);
+        if (carga->getVerbosidad() < VERB_TRAZA) return;
+
+        std::cout << "Trama: [L, " 
+             << (fragmento == ' ' ? "Space" : std::string(1, fragmento)) 
+             << "] -> Procesando...";
+        std::cout << " -> Fragmento '" << fragmento 
+             << "' decodificado como '" << dec << "'. ";
+        carga->imprimirProgreso();
+    }
+    
+    /**
+     * @brief Destructor
+     */
+    virtual ~TramaLoad() {}
+};
+
+/**************************************************************************
+ * @class TramaMap
+ * @brief Trama de tipo MAP que modifica la rotación del rotor
+ * 
+ * @details
+ * Representa una trama "M,N" donde N es un entero que indica cuántas
+ * posiciones debe rotar el rotor (positivo o negativo).
+ **************************************************************************/
+class TramaMap : public TramaBase {
+private:
+    int desplazamiento;  ///< Número de posiciones a rotar
+
+public:
+    /**
+     * @brief Constructor
+     * @param d Desplazamiento a aplicar al rotor
+     */
+    TramaMap(int d) : desplazamiento(d) {}
+    
+    /**
+     * @brief Procesa la trama MAP
+     * @param carga No se utiliza en tramas MAP
+     * @param rotor Rotor que será rotado
+     * @post El rotor se rota N posiciones
+     */
+    virtual void procesar(ListaDeCarga* carga, RotorActivo* rotor) {
+        ejecutar(desplazamiento, carga, rotor);
+    }
+
+    /**
+     * @brief Lógica de una trama MAP sin necesidad de instanciar el objeto
+     * @param desplazamiento Posiciones a rotar
+     * @param carga No se utiliza en tramas MAP
+     * @param rotor Rotor que será rotado (también define el nivel de detalle)
+     */
+    static void ejecutar(int desplazamiento, ListaDeCarga* carga, RotorActivo* rotor) {
+        (void)carga;
+        if (rotor->getVerbosidad() >= VERB_TRAZA)
+            std::cout << "Trama: [M," << desplazamiento << "] -> Procesando... ";
+        rotor->rotar(desplazamiento);
+        rotor->imprimirEstado();
+    }
+    
+    /**
+     * @brief Destructor
+     */
+    virtual ~TramaMap() {}
+};
+/**************************************************************************
+ * Funciones auxiliares
+ **************************************************************************/
+
+/**
+ * @brief Elimina espacios en blanco al inicio y final de una cadena
+ * @param s Cadena a modificar (in-place)
+ * @post s contiene la cadena sin espacios al inicio/final
+ */
+inline void trim(char* s) {
+    // Trim izquierdo
+    int i = 0;
+    while (s[i] && isspace((unsigned char)s[i])) ++i;
+    if (i > 0) memmove(s, s + i, strlen(s + i) + 1);
+    
+    // Trim derecho
+    int L = (int)strlen(s);
+    while (L > 0 && isspace((unsigned char)s[L-1])) 
+        s[--L] = '\0';
+}
+
+/**
+ * @enum TipoTrama
+ * @brief Tipo de una trama representada por valor
+ */
+enum TipoTrama {
+    TRAMA_INVALIDA,      ///< Línea vacía o mal formada
+    TRAMA_LOAD,          ///< Trama "L,X"
+    TRAMA_MAP            ///< Trama "M,N" o "M,<rotor>,N"
+};
+
+/**
+ * @struct Trama
+ * @brief Representación por valor (sin memoria dinámica) de una trama PRT-7
+ * 
+ * @details
+ * El parser la llena en el lugar y procesarTrama() la despacha con un switch,
+ * evitando el new/delete y la llamada virtual por línea del bucle principal.
+ */
+struct Trama {
+    TipoTrama tipo;      ///< Tipo de trama
+    char fragmento;      ///< Carácter de la trama LOAD
+    int desplazamiento;  ///< Desplazamiento de la trama MAP
+    int rotor;           ///< Rotor que gira la trama MAP (0 = el único o el primero)
+
+    /**
+     * @brief Constructor - trama inválida
+     */
+    Trama() : tipo(TRAMA_INVALIDA), fragmento(0), desplazamiento(0), rotor(0) {}
+};
+
+/**
+ * @enum ErrorTrama
+ * @brief Resultado de analizarTrama()
+ * @details Solo los errores con mensaje en describirErrorTrama() se informan
+ * en consola; los demás se descartan en silencio, como hacía strtok.
+ */
+enum ErrorTrama {
+    TRAMA_OK,                  ///< Trama válida
+    ERR_TRAMA_VACIA,           ///< Línea vacía o solo separadores
+    ERR_TIPO_DESCONOCIDO,      ///< Primer campo distinto de L / M
+    ERR_LOAD_SIN_ARGUMENTO,    ///< "L" sin segundo campo
+    ERR_MAP_SIN_ARGUMENTO,     ///< "M" sin segundo campo
+    ERR_ARGUMENTO_VACIO,       ///< "L" con el segundo campo en blanco
+    ERR_ROTOR_INVALIDO         ///< "M,<rotor>,N" con un rotor negativo
+};
+
+/**
+ * @brief Indica si un byte es espacio en blanco (mismo criterio que isspace)
+ * @param c Byte a revisar
+ * @return true para ' ', '\t', '\n', '\v', '\f' y '\r'
+ */
+inline bool esBlanco(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * @brief Recorta espacios en blanco de una vista [ini, fin) sin copiarla
+ * @param ini Inicio de la vista (se avanza)
+ * @param fin Fin de la vista (se retrocede)
+ */
+inline void trimVista(const char*& ini, const char*& fin) {
+    while (ini < fin && esBlanco(*ini)) ++ini;
+    while (fin > ini && esBlanco(fin[-1])) --fin;
+}
+
+/**
+ * @brief Extrae el siguiente campo separado por comas de una vista
+ * @param cur Posición actual (se avanza tras el campo)
+ * @param fin Fin de la vista
+ * @param campoIni Recibe el inicio del campo (ya recortado)
+ * @param campoFin Recibe el fin del campo (ya recortado)
+ * @return false si no quedan campos
+ * @details Igual que strtok, las comas consecutivas se tratan como una sola
+ */
+inline bool siguienteCampo(const char*& cur, const char* fin,
+                           const char*& campoIni, const char*& campoFin) {
+    while (cur < fin && *cur == ',') ++cur;
+    if (cur == fin) return false;
+    campoIni = cur;
+    const char* coma = (const char*)memchr(cur, ',', (size_t)(fin - cur));
+    cur = coma ? coma : fin;
+    campoFin = cur;
+    trimVista(campoIni, campoFin);
+    return true;
+}
+
+/**
+ * @brief Convierte una vista a entero con la semántica de atoi
+ * @param ini Inicio de la vista (sin espacios iniciales)
+ * @param fin Fin de la vista
+ * @return Valor leído (0 si no hay dígitos)
+ */
+inline int enteroVista(const char* ini, const char* fin) {
+    bool negativo = false;
+    if (ini < fin && (*ini == '-' || *ini == '+')) {
+        negativo = (*ini == '-');
+        ++ini;
+    }
+    long v = 0;
+    while (ini < fin && *ini >= '0' && *ini <= '9') {
+        if (v < 2147483648L) v = v * 10 + (*ini - '0');
+        ++ini;
+    }
+    if (negativo) v = -v;
+    if (v > 2147483647L) v = 2147483647L;
+    if (v < -2147483647L - 1) v = -2147483647L - 1;
+    return (int)v;
+}
+
+/**
+ * @brief Indica si una vista empieza por un entero (signo opcional y un dígito)
+ * @param ini Inicio de la vista (sin espacios iniciales)
+ * @param fin Fin de la vista
+ * @return true si enteroVista() leería al menos un dígito
+ */
+inline bool esEnteroVista(const char* ini, const char* fin) {
+    if (ini < fin && (*ini == '-' || *ini == '+')) ++ini;
+    return ini < fin && *ini >= '0' && *ini <= '9';
+}
+
+/**
+ * @brief Analiza una vista de línea en una sola pasada, sin imprimir nada
+ * @param linea Inicio de la línea (no necesita terminar en '\0')
+ * @param len Longitud de la línea
+ * @param t Trama a llenar (TRAMA_INVALIDA si hay error)
+ * @param conBanco true si hay un banco de rotores (--rotors) que direccionar
+ * @return TRAMA_OK o el motivo del rechazo
+ * @details
+ * Formatos válidos:
+ * - L,X : TRAMA_LOAD con carácter X (el primero si el campo tiene más)
+ * - L,Space : TRAMA_LOAD con espacio (sin distinguir mayúsculas)
+ * - M,N : TRAMA_MAP con desplazamiento N (puede ser negativo) para el rotor 0
+ * - M,R,N : solo con banco y N numérico, TRAMA_MAP con desplazamiento N
+ *   para el rotor R; sin banco los campos de más se ignoran como siempre
+ *
+ * Recorre los bytes de izquierda a derecha una sola vez: no copia la
+ * línea, no reserva memoria ni usa estado global, así que es reentrante y
+ * se puede llamar desde varios hilos a la vez. Acepta lo mismo que el parser
+ * anterior basado en strtok: espacios alrededor de cada campo, comas
+ * repetidas como separador único y el entero con la saturación de atoi.
+ */
+inline ErrorTrama analizarTrama(const char* linea, size_t len, Trama& t, bool conBanco = false) {
+    t.tipo = TRAMA_INVALIDA;
+    const char* p = linea;
+    const char* fin = linea + len;
+
+    // Primer campo: debe ser exactamente una letra L o M
+    while (p < fin && esBlanco(*p)) ++p;
+    while (p < fin && *p == ',') ++p;
+    while (p < fin && esBlanco(*p)) ++p;
+    if (p == fin || *p == ',') return ERR_TRAMA_VACIA;
+    char tipo = *p++;
+    while (p < fin && esBlanco(*p)) ++p;
+    if (p < fin && *p != ',') return ERR_TIPO_DESCONOCIDO;
+    bool esLoad = (tipo == 'L' || tipo == 'l');
+    if (!esLoad && tipo != 'M' && tipo != 'm') return ERR_TIPO_DESCONOCIDO;
+
+    // Segundo campo; si solo quedan blancos, no hay argumento
+    while (p < fin && *p == ',') ++p;
+    while (p < fin && esBlanco(*p)) ++p;
+    if (p == fin) return esLoad ? ERR_LOAD_SIN_ARGUMENTO : ERR_MAP_SIN_ARGUMENTO;
+
+    if (!esLoad) {
+        // enteroVista se detiene en el primer byte que no es dígito
+        t.tipo = TRAMA_MAP;
+        t.desplazamiento = enteroVista(p, fin);
+        t.rotor = 0;
+        if (!conBanco) return TRAMA_OK;
+        // Con banco, un tercer campo numérico convierte el segundo en el número de rotor
+        const char* cur = (const char*)memchr(p, ',', (size_t)(fin - p));
+        const char* arg;
+        const char* argFin;
+        if (cur && siguienteCampo(cur, fin, arg, argFin) && esEnteroVista(arg, argFin)) {
+            if (t.desplazamiento < 0) {
+                t.tipo = TRAMA_INVALIDA;
+                return ERR_ROTOR_INVALIDO;
+            }
+            t.rotor = t.desplazamiento;
+            t.desplazamiento = enteroVista(arg, argFin);
+        }
+        return TRAMA_OK;
+    }
+
+    if (*p == ',') return ERR_ARGUMENTO_VACIO;
+    t.tipo = TRAMA_LOAD;
+    t.fragmento = *p;
+    if ((*p == 'S' || *p == 's') && fin - p >= 5 && strncasecmp(p, "Space", 5) == 0) {
+        const char* q = p + 5;
+        while (q < fin && esBlanco(*q)) ++q;
+        if (q == fin || *q == ',') t.fragmento = ' ';
+    }
+    return TRAMA_OK;
+}
+
+/**
+ * @brief Mensaje de consola para un error de trama
+ * @param e Resultado de analizarTrama()
+ * @return Texto del mensaje, o nullptr si el error se descarta en silencio
+ * @details ERR_TIPO_DESCONOCIDO lleva además el primer campo a continuación
+ */
+inline const char* describirErrorTrama(ErrorTrama e) {
+    switch (e) {
+    case ERR_LOAD_SIN_ARGUMENTO: return "Trama L sin argumento.";
+    case ERR_MAP_SIN_ARGUMENTO:  return "Trama M sin argumento.";
+    case ERR_TIPO_DESCONOCIDO:   return "Tipo de trama desconocido: ";
+    case ERR_ROTOR_INVALIDO:     return "Trama M con rotor negativo.";
+    default:                     return nullptr;
+    }
+}
+
+/**
+ * @brief Informa en consola por qué se rechazó una línea
+ * @param e Resultado de analizarTrama() sobre la misma línea
+ * @param linea Inicio de la línea
+ * @param len Longitud de la línea
+ */
+inline void reportarErrorTrama(ErrorTrama e, const char* linea, size_t len) {
+    const char* msg = describirErrorTrama(e);
+    if (!msg) return;
+    std::cout << msg;
+    if (e == ERR_TIPO_DESCONOCIDO) {
+        const char* cur = linea;
+        const char* fin = linea + len;
+        const char* tok;
+        const char* tokFin;
+        trimVista(cur, fin);
+        if (siguienteCampo(cur, fin, tok, tokFin))
+            std::cout.write(tok, tokFin - tok);
+    }
+    std::cout << '\n';
+}
+
+/**
+ * @brief Parsea una vista de línea sobre una trama existente, sin copiarla
+ * @param linea Inicio de la línea (no necesita terminar en '\0')
+ * @param len Longitud de la línea
+ * @param t Trama a llenar
+ * @param reportar Si es true, describe en consola por qué la trama es inválida
+ * @param conBanco true si hay un banco de rotores (ver analizarTrama())
+ * @return true si la línea es una trama válida
+ * @details Envoltura de analizarTrama() que conserva los mensajes de consola
+ * del parser original; el camino caliente sin mensajes no imprime nada.
+ */
+inline bool parsearTrama(const char* linea, size_t len, Trama& t, bool reportar = true,
+                         bool conBanco = false) {
+    ErrorTrama e = analizarTrama(linea, len, t, conBanco);
+    if (e == TRAMA_OK) return true;
+    if (reportar) reportarErrorTrama(e, linea, len);
+    return false;
+}
+
+/**
+ * @brief Parsea una línea terminada en '\0' sobre una trama existente
+ * @param lineaC Línea a parsear (formato: "L,X" o "M,N")
+ * @param t Trama a llenar
+ * @return true si la línea es una trama válida
+ */
+inline bool parsearTrama(const char* lineaC, Trama& t) {
+    return parsearTrama(lineaC, strlen(lineaC), t);
+}
+
+/**
+ * @brief Parsea una línea de texto y crea la trama correspondiente
+ * @param lineaC Línea a parsear (formato: "L,X" o "M,N")
+ * @return Puntero a TramaBase* (debe liberarse con delete) o nullptr si inválida
+ * @details Envoltura polimórfica de parsearTrama() para quien necesite la
+ * jerarquía TramaBase (p. ej. nuevos tipos de trama).
+ */
+inline TramaBase* parseLinea(const char* lineaC) {
+    Trama t;
+    if (!parsearTrama(lineaC, t)) return nullptr;
+    if (t.tipo == TRAMA_LOAD) return new TramaLoad(t.fragmento);
+    // La jerarquía polimórfica solo conoce el rotor único
+    if (t.tipo == TRAMA_MAP && t.rotor == 0) return new TramaMap(t.desplazamiento);
+    return nullptr;
+}
+
+/**
+ * @brief Procesa una trama por valor sin despacho virtual
+ * @param t Trama ya parseada
+ * @param carga Lista de carga
+ * @param rotor Rotor de mapeo
+ * @post Mismo efecto que TramaLoad::procesar / TramaMap::procesar
+ */
+inline void procesarTrama(const Trama& t, ListaDeCarga* carga, RotorActivo* rotor) {
+    switch (t.tipo) {
+    case TRAMA_LOAD:
+        TramaLoad::ejecutar(t.fragmento, carga, rotor);
+        break;
+    case TRAMA_MAP:
+        if (t.rotor == 0) TramaMap::ejecutar(t.desplazamiento, carga, rotor);
+        break;
+    default:
+        break;
+    }
+}
+
+#endif // PRT7_TRAMAS_H